@@ -0,0 +1,614 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+#if !defined(CuContainer_DisableSimd) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define __CuContainer_Sse2__
+#include <emmintrin.h>
+#endif
+
+namespace CuContainer
+{
+	namespace Detail
+	{
+		using Ctrl = std::int8_t;
+
+		// full slots store the low 7 bits of the hash, so every special value has the sign bit set
+		constexpr Ctrl CtrlEmpty = -128;
+		constexpr Ctrl CtrlDeleted = -2;
+
+		constexpr bool IsFull(const Ctrl c)
+		{
+			return c >= 0;
+		}
+
+		// std::hash is the identity for integers on common implementations, the bits are mixed before probing
+		constexpr std::size_t Mix(std::size_t h)
+		{
+			if constexpr (sizeof(std::size_t) >= 8)
+			{
+				h ^= h >> 33;
+				h *= static_cast<std::size_t>(0xff51afd7ed558ccdull);
+				h ^= h >> 33;
+				h *= static_cast<std::size_t>(0xc4ceb9fe1a85ec53ull);
+				h ^= h >> 33;
+			}
+			else
+			{
+				h ^= h >> 16;
+				h *= static_cast<std::size_t>(0x85ebca6bu);
+				h ^= h >> 13;
+				h *= static_cast<std::size_t>(0xc2b2ae35u);
+				h ^= h >> 16;
+			}
+			return h;
+		}
+
+#ifdef __CuContainer_Sse2__
+		struct Group
+		{
+			static constexpr std::size_t Width = 16;
+			static constexpr int Shift = 0;
+
+			__m128i Value;
+
+			explicit Group(const Ctrl *ctrl) : Value(_mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl)))
+			{
+			}
+
+			[[nodiscard]] std::uint32_t Match(const Ctrl h2) const
+			{
+				return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), Value)));
+			}
+
+			[[nodiscard]] std::uint32_t MatchEmpty() const
+			{
+				return Match(CtrlEmpty);
+			}
+
+			[[nodiscard]] std::uint32_t MatchEmptyOrDeleted() const
+			{
+				return static_cast<std::uint32_t>(_mm_movemask_epi8(Value));
+			}
+		};
+#else
+		// SWAR fallback, Match may report false positives which the key comparison filters out
+		struct Group
+		{
+			static constexpr std::size_t Width = 8;
+			static constexpr int Shift = 3;
+			static constexpr std::uint64_t Lsbs = 0x0101010101010101ull;
+			static constexpr std::uint64_t Msbs = 0x8080808080808080ull;
+
+			std::uint64_t Value = 0;
+
+			explicit Group(const Ctrl *ctrl)
+			{
+				for (std::size_t i = 0; i < Width; ++i)
+					Value |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(ctrl[i])) << (i * 8);
+			}
+
+			[[nodiscard]] std::uint64_t Match(const Ctrl h2) const
+			{
+				const auto x = Value ^ (Lsbs * static_cast<std::uint8_t>(h2));
+				return (x - Lsbs) & ~x & Msbs;
+			}
+
+			[[nodiscard]] std::uint64_t MatchEmpty() const
+			{
+				return Value & ~(Value << 6) & Msbs;
+			}
+
+			[[nodiscard]] std::uint64_t MatchEmptyOrDeleted() const
+			{
+				return Value & Msbs;
+			}
+		};
+#endif
+
+		template <typename Mask>
+		constexpr std::size_t LowestIndex(const Mask mask)
+		{
+			return static_cast<std::size_t>(std::countr_zero(mask)) >> Group::Shift;
+		}
+
+		template <typename K>
+		struct SetPolicy
+		{
+			using KeyType = K;
+			using SlotType = K;
+
+			static const KeyType &GetKey(const SlotType &slot)
+			{
+				return slot;
+			}
+
+			template <typename Key>
+			static void Construct(SlotType *slot, Key &&key)
+			{
+				::new (static_cast<void *>(slot)) SlotType(std::forward<Key>(key));
+			}
+		};
+
+		template <typename K, typename V>
+		struct MapPolicy
+		{
+			using KeyType = K;
+			using SlotType = std::pair<K, V>;
+
+			static const KeyType &GetKey(const SlotType &slot)
+			{
+				return slot.first;
+			}
+
+			template <typename Key, typename... Args>
+			static void Construct(SlotType *slot, Key &&key, Args &&...args)
+			{
+				::new (static_cast<void *>(slot)) SlotType(std::piecewise_construct,
+														   std::forward_as_tuple(std::forward<Key>(key)),
+														   std::forward_as_tuple(std::forward<Args>(args)...));
+			}
+		};
+
+		// open addressing with one control byte per slot probed a group at a time (Swiss table layout).
+		// the first Group::Width control bytes are mirrored after the end so any group load stays in bounds
+		template <typename Policy, typename Hash, typename Eq>
+		class RawTable
+		{
+		public:
+			using KeyType = typename Policy::KeyType;
+			using SlotType = typename Policy::SlotType;
+
+			template <bool Const>
+			class IterBase
+			{
+			public:
+				using iterator_category = std::forward_iterator_tag;
+				using value_type = SlotType;
+				using difference_type = std::ptrdiff_t;
+				using pointer = std::conditional_t<Const, const SlotType *, SlotType *>;
+				using reference = std::conditional_t<Const, const SlotType &, SlotType &>;
+
+				IterBase() = default;
+
+				operator IterBase<true>() const
+				{
+					return IterBase<true>(ctrl, slots, idx, cap);
+				}
+
+				reference operator*() const
+				{
+					return slots[idx];
+				}
+
+				pointer operator->() const
+				{
+					return slots + idx;
+				}
+
+				IterBase &operator++()
+				{
+					++idx;
+					SkipEmpty();
+					return *this;
+				}
+
+				IterBase operator++(int)
+				{
+					auto tmp = *this;
+					++*this;
+					return tmp;
+				}
+
+				bool operator==(const IterBase &it) const
+				{
+					return idx == it.idx && slots == it.slots;
+				}
+
+				bool operator!=(const IterBase &it) const
+				{
+					return !(*this == it);
+				}
+
+			private:
+				friend class RawTable;
+				template <bool>
+				friend class IterBase;
+
+				const Ctrl *ctrl = nullptr;
+				pointer slots = nullptr;
+				std::size_t idx = 0;
+				std::size_t cap = 0;
+
+				IterBase(const Ctrl *ctrl, const pointer slots, const std::size_t idx, const std::size_t cap)
+					: ctrl(ctrl), slots(slots), idx(idx), cap(cap)
+				{
+				}
+
+				void SkipEmpty()
+				{
+					while (idx < cap && !IsFull(ctrl[idx]))
+						++idx;
+				}
+			};
+
+			using Iterator = IterBase<false>;
+			using ConstIterator = IterBase<true>;
+
+			RawTable() = default;
+
+			explicit RawTable(const Hash &hash, const Eq &eq = Eq{}) : hash(hash), eq(eq)
+			{
+			}
+
+			RawTable(const RawTable &table) : hash(table.hash), eq(table.eq)
+			{
+				Reserve(table.size);
+				for (const auto &slot : table)
+					CopyNew(slot);
+			}
+
+			RawTable(RawTable &&table) noexcept
+			{
+				Swap(table);
+			}
+
+			RawTable &operator=(RawTable table) noexcept
+			{
+				Swap(table);
+				return *this;
+			}
+
+			~RawTable()
+			{
+				Release();
+			}
+
+			void Swap(RawTable &table) noexcept
+			{
+				std::swap(ctrl, table.ctrl);
+				std::swap(slots, table.slots);
+				std::swap(cap, table.cap);
+				std::swap(size, table.size);
+				std::swap(growthLeft, table.growthLeft);
+				std::swap(hash, table.hash);
+				std::swap(eq, table.eq);
+			}
+
+			[[nodiscard]] std::size_t Length() const
+			{
+				return size;
+			}
+
+			[[nodiscard]] bool Empty() const
+			{
+				return size == 0;
+			}
+
+			[[nodiscard]] std::size_t Capacity() const
+			{
+				return cap;
+			}
+
+			void Clear()
+			{
+				Release();
+			}
+
+			// makes room for count elements without rehashing
+			void Reserve(const std::size_t count)
+			{
+				if (count <= size + growthLeft)
+					return;
+				auto newCap = std::max<std::size_t>(std::bit_ceil(count + count / 7 + 1), Group::Width);
+				while (MaxLoad(newCap) < count)
+					newCap *= 2;
+				Rehash(newCap);
+			}
+
+			[[nodiscard]] Iterator Find(const KeyType &key)
+			{
+				const auto i = FindIndex(key, HashOf(key));
+				return i == cap ? end() : Iterator(ctrl, slots, i, cap);
+			}
+
+			[[nodiscard]] ConstIterator Find(const KeyType &key) const
+			{
+				const auto i = FindIndex(key, HashOf(key));
+				return i == cap ? end() : ConstIterator(ctrl, slots, i, cap);
+			}
+
+			[[nodiscard]] bool Contains(const KeyType &key) const
+			{
+				return FindIndex(key, HashOf(key)) != cap;
+			}
+
+			// args are only used when the key is not present yet
+			template <typename Key, typename... Args>
+			std::pair<Iterator, bool> TryEmplace(Key &&key, Args &&...args)
+			{
+				const auto h = HashOf(key);
+				if (const auto i = FindIndex(key, h); i != cap)
+					return {Iterator(ctrl, slots, i, cap), false};
+				const auto i = InsertNew(h, std::forward<Key>(key), std::forward<Args>(args)...);
+				return {Iterator(ctrl, slots, i, cap), true};
+			}
+
+			std::size_t Erase(const KeyType &key)
+			{
+				const auto i = FindIndex(key, HashOf(key));
+				if (i == cap)
+					return 0;
+				EraseAt(i);
+				return 1;
+			}
+
+			Iterator Erase(ConstIterator it)
+			{
+				EraseAt(it.idx);
+				Iterator next(ctrl, slots, it.idx, cap);
+				next.SkipEmpty();
+				return next;
+			}
+
+			[[nodiscard]] Iterator begin()
+			{
+				Iterator it(ctrl, slots, 0, cap);
+				it.SkipEmpty();
+				return it;
+			}
+
+			[[nodiscard]] ConstIterator begin() const
+			{
+				ConstIterator it(ctrl, slots, 0, cap);
+				it.SkipEmpty();
+				return it;
+			}
+
+			[[nodiscard]] Iterator end()
+			{
+				return Iterator(ctrl, slots, cap, cap);
+			}
+
+			[[nodiscard]] ConstIterator end() const
+			{
+				return ConstIterator(ctrl, slots, cap, cap);
+			}
+
+		private:
+			Ctrl *ctrl = nullptr;
+			SlotType *slots = nullptr;
+			std::size_t cap = 0;
+			std::size_t size = 0;
+			std::size_t growthLeft = 0;
+			Hash hash{};
+			Eq eq{};
+
+			static constexpr std::size_t MaxLoad(const std::size_t capacity)
+			{
+				return capacity - capacity / 8;
+			}
+
+			[[nodiscard]] std::size_t HashOf(const KeyType &key) const
+			{
+				return Mix(hash(key));
+			}
+
+			static Ctrl H2(const std::size_t h)
+			{
+				return static_cast<Ctrl>(h & 0x7f);
+			}
+
+			// groups start at triangular offsets, which visits every group of a power of two table
+			[[nodiscard]] std::size_t FindIndex(const KeyType &key, const std::size_t h) const
+			{
+				if (cap == 0)
+					return cap;
+				const auto mask = cap - 1;
+				const auto h2 = H2(h);
+				auto pos = (h >> 7) & mask;
+				for (std::size_t step = Group::Width;; step += Group::Width)
+				{
+					const Group g(ctrl + pos);
+					for (auto m = g.Match(h2); m != 0; m &= m - 1)
+					{
+						const auto i = (pos + LowestIndex(m)) & mask;
+						if (eq(Policy::GetKey(slots[i]), key))
+							return i;
+					}
+					if (g.MatchEmpty() != 0)
+						return cap;
+					pos = (pos + step) & mask;
+				}
+			}
+
+			[[nodiscard]] std::size_t FindFree(const std::size_t h) const
+			{
+				const auto mask = cap - 1;
+				auto pos = (h >> 7) & mask;
+				for (std::size_t step = Group::Width;; step += Group::Width)
+				{
+					if (const auto m = Group(ctrl + pos).MatchEmptyOrDeleted(); m != 0)
+						return (pos + LowestIndex(m)) & mask;
+					pos = (pos + step) & mask;
+				}
+			}
+
+			void SetCtrl(const std::size_t i, const Ctrl c)
+			{
+				ctrl[i] = c;
+				if (i < Group::Width)
+					ctrl[cap + i] = c;
+			}
+
+			template <typename... Args>
+			std::size_t InsertNew(const std::size_t h, Args &&...args)
+			{
+				auto i = cap == 0 ? cap : FindFree(h);
+				if (i == cap || (growthLeft == 0 && ctrl[i] == CtrlEmpty))
+				{
+					// mostly tombstones: rebuild at the same size instead of growing
+					Rehash(cap != 0 && size <= MaxLoad(cap) / 2 ? cap : std::max(cap * 2, Group::Width));
+					i = FindFree(h);
+				}
+				Policy::Construct(slots + i, std::forward<Args>(args)...);
+				if (ctrl[i] == CtrlEmpty)
+					--growthLeft;
+				SetCtrl(i, H2(h));
+				++size;
+				return i;
+			}
+
+			void CopyNew(const SlotType &slot)
+			{
+				const auto h = HashOf(Policy::GetKey(slot));
+				const auto i = FindFree(h);
+				::new (static_cast<void *>(slots + i)) SlotType(slot);
+				--growthLeft;
+				SetCtrl(i, H2(h));
+				++size;
+			}
+
+			void EraseAt(const std::size_t i)
+			{
+				std::destroy_at(slots + i);
+				SetCtrl(i, CtrlDeleted);
+				--size;
+			}
+
+			void Rehash(const std::size_t newCap)
+			{
+				auto *newCtrl = new Ctrl[newCap + Group::Width];
+				std::fill_n(newCtrl, newCap + Group::Width, CtrlEmpty);
+				auto *newSlots = std::allocator<SlotType>{}.allocate(newCap);
+
+				auto *oldCtrl = std::exchange(ctrl, newCtrl);
+				auto *oldSlots = std::exchange(slots, newSlots);
+				const auto oldCap = std::exchange(cap, newCap);
+				growthLeft = MaxLoad(newCap) - size;
+
+				for (std::size_t i = 0; i < oldCap; ++i)
+				{
+					if (!IsFull(oldCtrl[i]))
+						continue;
+					const auto h = HashOf(Policy::GetKey(oldSlots[i]));
+					const auto j = FindFree(h);
+					::new (static_cast<void *>(slots + j)) SlotType(std::move(oldSlots[i]));
+					std::destroy_at(oldSlots + i);
+					SetCtrl(j, H2(h));
+				}
+
+				if (oldCap != 0)
+				{
+					std::allocator<SlotType>{}.deallocate(oldSlots, oldCap);
+					delete[] oldCtrl;
+				}
+			}
+
+			void Release()
+			{
+				if (cap == 0)
+					return;
+				for (std::size_t i = 0; i < cap; ++i)
+					if (IsFull(ctrl[i]))
+						std::destroy_at(slots + i);
+				std::allocator<SlotType>{}.deallocate(slots, cap);
+				delete[] ctrl;
+				ctrl = nullptr;
+				slots = nullptr;
+				cap = size = growthLeft = 0;
+			}
+		};
+	} // namespace Detail
+
+	template <typename K, typename Hash = std::hash<K>, typename Eq = std::equal_to<K>>
+	class FlatHashSet : public Detail::RawTable<Detail::SetPolicy<K>, Hash, Eq>
+	{
+		using Base = Detail::RawTable<Detail::SetPolicy<K>, Hash, Eq>;
+
+	public:
+		using Base::Base;
+
+		FlatHashSet(std::initializer_list<K> list)
+		{
+			this->Reserve(list.size());
+			for (const auto &k : list)
+				Insert(k);
+		}
+
+		std::pair<typename Base::Iterator, bool> Insert(const K &key)
+		{
+			return this->TryEmplace(key);
+		}
+
+		std::pair<typename Base::Iterator, bool> Insert(K &&key)
+		{
+			return this->TryEmplace(std::move(key));
+		}
+	};
+
+	// elements are std::pair<K, V>, keys must not be modified through iterators
+	template <typename K, typename V, typename Hash = std::hash<K>, typename Eq = std::equal_to<K>>
+	class FlatHashMap : public Detail::RawTable<Detail::MapPolicy<K, V>, Hash, Eq>
+	{
+		using Base = Detail::RawTable<Detail::MapPolicy<K, V>, Hash, Eq>;
+
+	public:
+		using Base::Base;
+
+		FlatHashMap(std::initializer_list<std::pair<K, V>> list)
+		{
+			this->Reserve(list.size());
+			for (const auto &kv : list)
+				Insert(kv);
+		}
+
+		std::pair<typename Base::Iterator, bool> Insert(const std::pair<K, V> &kv)
+		{
+			return this->TryEmplace(kv.first, kv.second);
+		}
+
+		std::pair<typename Base::Iterator, bool> Insert(std::pair<K, V> &&kv)
+		{
+			return this->TryEmplace(std::move(kv.first), std::move(kv.second));
+		}
+
+		V &operator[](const K &key)
+		{
+			return this->TryEmplace(key).first->second;
+		}
+
+		V &operator[](K &&key)
+		{
+			return this->TryEmplace(std::move(key)).first->second;
+		}
+
+		[[nodiscard]] V &At(const K &key)
+		{
+			const auto it = this->Find(key);
+			if (it == this->end())
+				throw std::out_of_range("CuContainer::FlatHashMap::At: key not found");
+			return it->second;
+		}
+
+		[[nodiscard]] const V &At(const K &key) const
+		{
+			const auto it = this->Find(key);
+			if (it == this->end())
+				throw std::out_of_range("CuContainer::FlatHashMap::At: key not found");
+			return it->second;
+		}
+	};
+} // namespace CuContainer
+
+#undef __CuContainer_Sse2__
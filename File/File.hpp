@@ -4,9 +4,27 @@
 #include <filesystem>
 #include <fstream>
 #include <span>
+#include <utility>
+#include <vector>
 
 #include "../Exception/Except.hpp"
 
+#ifdef CuUtil_Platform_Windows
+// keep the min/max macros out, they break std::max in every header included after this one
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace CuFile
 {
     CuExcept_MakeException(Exception, CuExcept, Exception);
@@ -134,6 +152,179 @@ namespace CuFile
         WriteAllBytes(path, data.data(), data.size_bytes());
     }
 
+    enum class MapAccess
+    {
+        Normal,
+        Sequential,
+        Random,
+        WillNeed
+    };
+
+    // read-only view of a whole file, one instance can be shared between threads and readers
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+
+        explicit MappedFile(const std::filesystem::path &path, const MapAccess access = MapAccess::Sequential)
+        {
+#ifdef CuUtil_Platform_Windows
+            file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                               access == MapAccess::Sequential ? FILE_FLAG_SEQUENTIAL_SCAN
+                               : access == MapAccess::Random   ? FILE_FLAG_RANDOM_ACCESS
+                                                               : FILE_ATTRIBUTE_NORMAL,
+                               nullptr);
+            if (file == INVALID_HANDLE_VALUE)
+                throw Exception("open file failed");
+
+            LARGE_INTEGER fileSize{};
+            if (!GetFileSizeEx(file, &fileSize))
+            {
+                Close();
+                throw Exception("get file size failed");
+            }
+            size = static_cast<size_t>(fileSize.QuadPart);
+            if (size == 0)
+                return;
+
+            mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping == nullptr)
+            {
+                Close();
+                throw Exception("create file mapping failed");
+            }
+            data = static_cast<const uint8_t *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            if (data == nullptr)
+            {
+                Close();
+                throw Exception("map view of file failed");
+            }
+#else
+            fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0)
+                throw Exception("open file failed");
+
+            struct stat st{};
+            if (fstat(fd, &st) != 0)
+            {
+                Close();
+                throw Exception("stat file failed");
+            }
+            size = static_cast<size_t>(st.st_size);
+            if (size == 0)
+                return;
+
+            auto *ptr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+            if (ptr == MAP_FAILED)
+            {
+                Close();
+                throw Exception("mmap failed");
+            }
+            data = static_cast<const uint8_t *>(ptr);
+#endif
+            Advise(access);
+        }
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        MappedFile(MappedFile &&mf) noexcept
+        {
+            *this = std::move(mf);
+        }
+
+        MappedFile &operator=(MappedFile &&mf) noexcept
+        {
+            if (this == &mf)
+                return *this;
+
+            Close();
+            data = std::exchange(mf.data, nullptr);
+            size = std::exchange(mf.size, 0);
+#ifdef CuUtil_Platform_Windows
+            file = std::exchange(mf.file, INVALID_HANDLE_VALUE);
+            mapping = std::exchange(mf.mapping, nullptr);
+#else
+            fd = std::exchange(mf.fd, -1);
+#endif
+            return *this;
+        }
+
+        ~MappedFile()
+        {
+            Close();
+        }
+
+        [[nodiscard]] const uint8_t *Data() const { return data; }
+        [[nodiscard]] size_t Size() const { return size; }
+        [[nodiscard]] std::span<const uint8_t> Span() const { return {data, size}; }
+
+        // readahead hint for [offset, offset + length), length 0 means to the end. Only a hint, failures are ignored
+        void Advise(const MapAccess access, const size_t offset = 0, size_t length = 0) const
+        {
+            if (data == nullptr || offset >= size)
+                return;
+            if (length == 0 || length > size - offset)
+                length = size - offset;
+
+#ifdef CuUtil_Platform_Windows
+            if (access == MapAccess::WillNeed)
+            {
+                WIN32_MEMORY_RANGE_ENTRY range{const_cast<uint8_t *>(data + offset), length};
+                PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+            }
+#else
+            // madvise wants a page aligned start
+            const auto page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            const auto begin = offset / page * page;
+            const auto advice = access == MapAccess::Sequential ? MADV_SEQUENTIAL
+                                : access == MapAccess::Random   ? MADV_RANDOM
+                                : access == MapAccess::WillNeed ? MADV_WILLNEED
+                                                                : MADV_NORMAL;
+            madvise(const_cast<uint8_t *>(data) + begin, length + offset - begin, advice);
+#if defined(POSIX_FADV_SEQUENTIAL)
+            const auto fadvice = access == MapAccess::Sequential ? POSIX_FADV_SEQUENTIAL
+                                 : access == MapAccess::Random   ? POSIX_FADV_RANDOM
+                                 : access == MapAccess::WillNeed ? POSIX_FADV_WILLNEED
+                                                                 : POSIX_FADV_NORMAL;
+            posix_fadvise(fd, static_cast<off_t>(offset), static_cast<off_t>(length), fadvice);
+#endif
+#endif
+        }
+
+    private:
+        const uint8_t *data = nullptr;
+        size_t size = 0;
+#ifdef CuUtil_Platform_Windows
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = nullptr;
+#else
+        int fd = -1;
+#endif
+
+        void Close()
+        {
+#ifdef CuUtil_Platform_Windows
+            if (data)
+                UnmapViewOfFile(data);
+            if (mapping)
+                CloseHandle(mapping);
+            if (file != INVALID_HANDLE_VALUE)
+                CloseHandle(file);
+            file = INVALID_HANDLE_VALUE;
+            mapping = nullptr;
+#else
+            if (data)
+                munmap(const_cast<uint8_t *>(data), size);
+            if (fd >= 0)
+                close(fd);
+            fd = -1;
+#endif
+            data = nullptr;
+            size = 0;
+        }
+    };
+
     inline void WriteAllText(const std::filesystem::path &path, const std::string_view &text)
     {
         auto fs = OpenForWrite(path, std::ios::out);
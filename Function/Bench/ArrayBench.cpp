@@ -0,0 +1,336 @@
+// baseline of CuFunc::Array against hand written STL, both allocating from their own pmr::CountingResource.
+// times and allocation counts are per call and include copying the input
+// g++ -std=c++20 -O2 Function/Bench/ArrayBench.cpp -o ArrayBench
+
+#include "../Function.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iterator>
+#include <memory_resource>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace
+{
+	using Resource = CuFunc::pmr::CountingResource;
+
+	template <typename T>
+	using PmrVector = std::pmr::vector<T>;
+
+	volatile std::size_t Sink = 0;
+
+	struct Result
+	{
+		double Micros = 0;
+		std::size_t Allocations = 0;
+		std::size_t PeakBytes = 0;
+	};
+
+	template <typename Func>
+	Result Measure(Resource &res, Func fn, const int reps)
+	{
+		// one warm up call, then only the timed calls are counted
+		Sink = Sink + fn(&res);
+		res.Reset();
+
+		const auto begin = std::chrono::steady_clock::now();
+		for (int i = 0; i < reps; ++i)
+			Sink = Sink + fn(&res);
+		const auto end = std::chrono::steady_clock::now();
+
+		return {std::chrono::duration<double, std::micro>(end - begin).count() / reps,
+				res.Allocations() / reps, res.PeakBytes()};
+	}
+
+	// static factories such as Range and Unfold default-construct their allocator, so for pmr arrays
+	// they allocate from the default resource
+	struct DefaultResource
+	{
+		std::pmr::memory_resource *Prev;
+
+		explicit DefaultResource(std::pmr::memory_resource *res) : Prev(std::pmr::set_default_resource(res)) {}
+		~DefaultResource() { std::pmr::set_default_resource(Prev); }
+	};
+
+	template <typename ArrayFunc, typename StlFunc>
+	void Row(const char *name, const char *type, const std::size_t n, ArrayFunc arrayFn, StlFunc stlFn, int reps = 0)
+	{
+		Resource arrayRes, stlRes;
+		if (reps <= 0)
+			reps = n <= 1000 ? 2000 : 20;
+		const auto a = Measure(arrayRes, arrayFn, reps);
+		const auto s = Measure(stlRes, stlFn, reps);
+		std::printf("%-10s %-6s %7zu | %10.1f us %7zu allocs %10zu B | %10.1f us %7zu allocs %10zu B | x%.2f\n",
+					name, type, n, a.Micros, a.Allocations, a.PeakBytes, s.Micros, s.Allocations, s.PeakBytes,
+					a.Micros / s.Micros);
+	}
+
+	void RunInt(const std::size_t n, std::mt19937 &rng)
+	{
+		std::vector<int> src(n);
+		for (auto &x : src)
+			x = static_cast<int>(rng() % (n / 4 + 1));
+
+		const auto arr = [&](Resource *r)
+		{ return CuFunc::pmr::Array<int>(src.begin(), src.end(), r); };
+		const auto vec = [&](Resource *r)
+		{ return PmrVector<int>(src.begin(), src.end(), r); };
+
+		Row("Range", "int", n, [&](Resource *r)
+			{
+				DefaultResource scope(r);
+				return CuFunc::pmr::Array<int>::Range(1, n, 3).Length();
+			},
+			[&](Resource *r)
+			{
+				PmrVector<int> out(r);
+				for (std::size_t i = 0; i < n; ++i)
+					out.push_back(1 + static_cast<int>(i) * 3);
+				return out.size();
+			});
+
+		Row("Unfold", "int", n, [&](Resource *r)
+			{
+				DefaultResource scope(r);
+				return CuFunc::pmr::Array<int>::Unfold([&](const int i)
+													   { return i < static_cast<int>(n) ? std::optional(std::pair(i * 2, i + 1)) : std::nullopt; },
+													   0)
+					.Length();
+			},
+			[&](Resource *r)
+			{
+				PmrVector<int> out(r);
+				for (int i = 0; i < static_cast<int>(n); ++i)
+					out.push_back(i * 2);
+				return out.size();
+			});
+
+		Row("Map", "int", n, [&](Resource *r)
+			{ return arr(r).Map([](const int x)
+								{ return x * 3 + 1; })
+				  .Length(); },
+			[&](Resource *r)
+			{
+				auto v = vec(r);
+				PmrVector<int> out(r);
+				out.reserve(v.size());
+				for (const auto x : v)
+					out.push_back(x * 3 + 1);
+				return out.size();
+			});
+
+		Row("Filter", "int", n, [&](Resource *r)
+			{ return arr(r).Filter([](const int x)
+								   { return x % 3 == 0; })
+				  .Length(); },
+			[&](Resource *r)
+			{
+				auto v = vec(r);
+				PmrVector<int> out(r);
+				std::copy_if(v.begin(), v.end(), std::back_inserter(out), [](const int x)
+							 { return x % 3 == 0; });
+				return out.size();
+			});
+
+		Row("Choose", "int", n, [&](Resource *r)
+			{ return arr(r).Choose([](const int x)
+								   { return x % 2 ? std::optional<int>(x) : std::nullopt; })
+				  .Length(); },
+			[&](Resource *r)
+			{
+				auto v = vec(r);
+				PmrVector<int> out(r);
+				for (const auto x : v)
+					if (x % 2)
+						out.push_back(x);
+				return out.size();
+			});
+
+		Row("Collect", "int", n, [&](Resource *r)
+			{
+				auto a = arr(r);
+				return a.Collect([&](const int x)
+								 {
+									 auto b = a.NewArray();
+									 b.Data.assign({x, x});
+									 return b; })
+					.Length();
+			},
+			[&](Resource *r)
+			{
+				auto v = vec(r);
+				PmrVector<int> out(r);
+				for (const auto x : v)
+				{
+					out.push_back(x);
+					out.push_back(x);
+				}
+				return out.size();
+			},
+			// Collect is quadratic, a single call at 100000 already takes seconds
+			n <= 1000 ? 200 : 1);
+
+		Row("GroupBy", "int", n, [&](Resource *r)
+			{ return arr(r).GroupBy([](const int x)
+									{ return x % 64; })
+				  .Length(); },
+			[&](Resource *r)
+			{
+				auto v = vec(r);
+				std::pmr::unordered_map<int, PmrVector<int>> groups(r);
+				for (const auto x : v)
+					groups[x % 64].push_back(x);
+				return groups.size();
+			});
+
+		Row("SortBy", "int", n, [&](Resource *r)
+			{ return arr(r).SortBy([](const int x)
+								   { return -x; })
+				  .Length(); },
+			[&](Resource *r)
+			{
+				auto v = vec(r);
+				std::stable_sort(v.begin(), v.end(), [](const int a, const int b)
+								 { return -a < -b; });
+				return v.size();
+			});
+
+		Row("Distinct", "int", n, [&](Resource *r)
+			{ return arr(r).Distinct().Length(); },
+			[&](Resource *r)
+			{
+				auto v = vec(r);
+				std::pmr::unordered_set<int> seen(r);
+				PmrVector<int> out(r);
+				for (const auto x : v)
+					if (seen.insert(x).second)
+						out.push_back(x);
+				return out.size();
+			});
+
+		const auto windows = [&](Resource *r)
+		{
+			auto v = vec(r);
+			std::size_t count = 0;
+			for (std::size_t i = 0; i + 8 <= v.size(); ++i)
+				count += std::span(v).subspan(i, 8).size();
+			return count;
+		};
+		Row("Windowed", "int", n, [&](Resource *r)
+			{ return arr(r).Windowed(8).Length(); },
+			windows);
+		Row("WinView", "int", n, [&](Resource *r)
+			{ return arr(r).WindowedView(8).Length(); },
+			windows);
+
+		Row("Scan", "int", n, [&](Resource *r)
+			{ return arr(r).Scan(std::plus<>{}, 0).Length(); },
+			[&](Resource *r)
+			{
+				auto v = vec(r);
+				PmrVector<int> out(v.size() + 1, r);
+				out[0] = 0;
+				std::inclusive_scan(v.begin(), v.end(), out.begin() + 1);
+				return out.size();
+			});
+
+		Row("Zip", "int", n, [&](Resource *r)
+			{
+				auto a = arr(r);
+				return a.Zip(a).Length();
+			},
+			[&](Resource *r)
+			{
+				auto v = vec(r);
+				PmrVector<std::pair<int, int>> out(r);
+				out.reserve(v.size());
+				for (const auto x : v)
+					out.emplace_back(x, x);
+				return out.size();
+			});
+
+		Row("Partition", "int", n, [&](Resource *r)
+			{ return arr(r).Partition([](const int x)
+									  { return x % 2 != 0; })
+				  .first.Length(); },
+			[&](Resource *r)
+			{
+				auto v = vec(r);
+				PmrVector<int> a(r), b(r);
+				std::partition_copy(v.begin(), v.end(), std::back_inserter(a), std::back_inserter(b), [](const int x)
+									{ return x % 2 != 0; });
+				return a.size();
+			});
+	}
+
+	void RunString(const std::size_t n, std::mt19937 &rng)
+	{
+		// longer than the small string buffer, so every copy allocates
+		std::vector<std::string> src(n);
+		for (auto &s : src)
+			s = "key-" + std::to_string(rng() % (n / 4 + 1)) + "-padding-beyond-sso";
+
+		const auto arr = [&](Resource *r)
+		{ return CuFunc::pmr::Array<std::string>(src.begin(), src.end(), r); };
+		const auto vec = [&](Resource *r)
+		{ return PmrVector<std::string>(src.begin(), src.end(), r); };
+
+		Row("Map", "string", n, [&](Resource *r)
+			{ return arr(r).Map([](const std::string &s)
+								{ return s.size(); })
+				  .Length(); },
+			[&](Resource *r)
+			{
+				auto v = vec(r);
+				PmrVector<std::size_t> out(r);
+				out.reserve(v.size());
+				for (const auto &s : v)
+					out.push_back(s.size());
+				return out.size();
+			});
+
+		Row("SortBy", "string", n, [&](Resource *r)
+			{ return arr(r).SortBy([](const std::string &s)
+								   { return s; })
+				  .Length(); },
+			[&](Resource *r)
+			{
+				auto v = vec(r);
+				std::stable_sort(v.begin(), v.end());
+				return v.size();
+			});
+
+		Row("Distinct", "string", n, [&](Resource *r)
+			{ return arr(r).Distinct().Length(); },
+			[&](Resource *r)
+			{
+				auto v = vec(r);
+				std::pmr::unordered_set<std::string> seen(r);
+				PmrVector<std::string> out(r);
+				for (const auto &s : v)
+					if (seen.insert(s).second)
+						out.push_back(s);
+				return out.size();
+			});
+	}
+}
+
+int main()
+{
+	std::printf("%-10s %-6s %7s | %-42s | %-42s | Array/STL time\n", "op", "type", "n", "Array", "STL");
+	for (const std::size_t n : {std::size_t{1000}, std::size_t{100000}})
+	{
+		std::mt19937 rng(3);
+		RunInt(n, rng);
+		RunString(n, rng);
+	}
+}
@@ -2,16 +2,25 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <functional>
 #include <iterator>
+#include <memory>
+#include <memory_resource>
 #include <numeric>
+#include <optional>
+#include <span>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <variant>
 #include <vector>
 #include <stdexcept>
 
+#include "../Container/Container.hpp"
+#include "../Simd/Simd.hpp"
+
 #undef min
 #undef max
 
@@ -35,6 +44,30 @@ namespace CuFunc
 					return &str[i + 1];
 			return str;
 		}
+
+		// (key, index) pairs ordered by key, ties keep the original order
+		struct KeyIndexLess
+		{
+			template <typename T>
+			bool operator()(const T &a, const T &b) const
+			{
+				if (std::less<>()(a.first, b.first))
+					return true;
+				if (std::less<>()(b.first, a.first))
+					return false;
+				return a.second < b.second;
+			}
+		};
+
+		template <typename T, typename Alloc, typename Keys>
+		void ApplyKeyOrder(std::vector<T, Alloc> &data, const Keys &keys)
+		{
+			std::vector<T, Alloc> buf(data.get_allocator());
+			buf.reserve(data.size());
+			for (const auto &k : keys)
+				buf.push_back(std::move(data[k.second]));
+			data = std::move(buf);
+		}
 	} // namespace __Detail
 
 	class Exception : public std::runtime_error
@@ -383,6 +416,7 @@ namespace CuFunc
 #define FunctionHelperBody                                                             \
 	{                                                                                  \
 		using Result = TR;                                                             \
+		using Args = std::tuple<TArgs...>;                                             \
 		static constexpr auto ArgsN = sizeof...(TArgs);                                \
 		template <std::size_t Idx>                                                     \
 		struct Arg                                                                     \
@@ -400,6 +434,9 @@ namespace CuFunc
 	template <typename Fn, typename TR, typename... TArgs>
 	struct FunctionHelper<TR (Fn::*)(TArgs...)> FunctionHelperBody;
 
+	template <typename Fn, typename TR, typename... TArgs>
+	struct FunctionHelper<TR (Fn::*)(TArgs...) const> FunctionHelperBody;
+
 #define MakeConditional(name, tf, ff)                                        \
 	template <typename CondFn, typename TrueFn, typename FalseFn>            \
 	struct Conditional##name                                                 \
@@ -423,33 +460,113 @@ namespace CuFunc
 	MakeConditional(_1_0, v, );
 	MakeConditional(_0_1, , v);
 
-	template <typename T>
+	namespace __Detail
+	{
+		// the R operators Map hands to CuSimd::Transform, by the std functor they apply
+		template <typename Func, typename T>
+		struct SimdScalarOp
+		{
+			using Op = void;
+		};
+
+		template <typename T>
+		struct SimdScalarOp<PlusR<T>, T>
+		{
+			using Op = std::plus<>;
+		};
+
+		template <typename T>
+		struct SimdScalarOp<MinusR<T>, T>
+		{
+			using Op = std::minus<>;
+		};
+
+		template <typename T>
+		struct SimdScalarOp<MultipliesR<T>, T>
+		{
+			using Op = std::multiplies<>;
+		};
+
+		template <typename T>
+		struct SimdScalarOp<DividesR<T>, T>
+		{
+			using Op = std::divides<>;
+		};
+
+		template <typename Func, typename T>
+		constexpr bool IsSimdScalarOp = CuSimd::IsVectorOp<typename SimdScalarOp<std::decay_t<Func>, T>::Op, T>;
+
+		// the elements of an Array are its Data, any other container is iterated as is
+		template <typename C>
+		auto &CollectRange(C &c)
+		{
+			if constexpr (requires { c.Data; })
+				return c.Data;
+			else
+				return c;
+		}
+
+		template <typename C>
+		using CollectValue = typename std::iterator_traits<decltype(std::begin(CollectRange(std::declval<C &>())))>::value_type;
+	} // namespace __Detail
+
+	template <typename T, typename Gen>
+	struct Seq;
+
+	// arrays shorter than this take the sequential path in ParArray
+	constexpr std::size_t DefaultParallelThreshold = 1 << 15;
+
+	template <typename T, typename Alloc = std::allocator<T>>
+	struct ParArray;
+
+	// Alloc is rebound for every array a combinator returns, so a pipeline stays on the allocator of its source
+	template <typename T, typename Alloc = std::allocator<T>>
 	struct Array
 	{
 		using ValueType = T;
+		using AllocatorType = Alloc;
 
-		std::vector<ValueType> Data{};
+		template <typename U>
+		using Rebind = Array<U, typename std::allocator_traits<AllocatorType>::template rebind_alloc<U>>;
+
+		std::vector<ValueType, AllocatorType> Data{};
 
 		Array() = default;
 
-		Array(std::initializer_list<ValueType> list) : Data(list)
+		explicit Array(const AllocatorType &alloc) : Data(alloc)
+		{
+		}
+
+		Array(std::initializer_list<ValueType> list, const AllocatorType &alloc = AllocatorType()) : Data(list, alloc)
 		{
 		}
 
-		explicit Array(std::vector<T> cont) : Data(std::move(cont))
+		explicit Array(std::vector<T, AllocatorType> cont) : Data(std::move(cont))
 		{
 		}
 
 		template <std::size_t Size>
-		explicit Array(std::array<T, Size> cont)
+		explicit Array(std::array<T, Size> cont, const AllocatorType &alloc = AllocatorType())
+			: Data(cont.begin(), cont.end(), alloc)
 		{
-			std::copy(cont.begin(), cont.end(), std::back_inserter(Data));
 		}
 
 		template <typename It>
-		Array(It begin, It end)
+		Array(It begin, It end, const AllocatorType &alloc = AllocatorType()) : Data(begin, end, alloc)
+		{
+		}
+
+		[[nodiscard]] AllocatorType GetAllocator() const
+		{
+			return Data.get_allocator();
+		}
+
+		// empty array of U on the rebound allocator
+		template <typename U = ValueType>
+		[[nodiscard]] Rebind<U> NewArray() const
 		{
-			std::copy(begin, end, std::back_inserter(Data));
+			using A = typename std::allocator_traits<AllocatorType>::template rebind_alloc<U>;
+			return Rebind<U>(A(Data.get_allocator()));
 		}
 
 		template <typename Cont>
@@ -478,13 +595,32 @@ namespace CuFunc
 			return ToVector();
 		}
 
-		[[nodiscard]] decltype(auto) Append(const Array<ValueType> &val) const
+		[[nodiscard]] decltype(auto) Append(const Array &val) const &
 		{
-			Array<ValueType> buf(Data);
+			auto buf = Copy();
 			buf.Data.insert(buf.Data.end(), val.Data.begin(), val.Data.end());
 			return buf;
 		}
 
+		// rvalue overloads reuse the buffer of the temporary instead of copying it
+		[[nodiscard]] Array Append(const Array &val) &&
+		{
+			Data.insert(Data.end(), val.Data.begin(), val.Data.end());
+			return std::move(*this);
+		}
+
+		// borrows Data, the array must outlive the sequence
+		[[nodiscard]] decltype(auto) AsSeq() const
+		{
+			auto gen = [data = &Data](auto &&sink)
+			{
+				for (const auto &it : *data)
+					if (!sink(it))
+						return;
+			};
+			return Seq<ValueType, decltype(gen)>(std::move(gen));
+		}
+
 		[[nodiscard]] decltype(auto) Average() const
 		{
 			if (Empty())
@@ -500,15 +636,20 @@ namespace CuFunc
 
 		template <typename Cont>
 		[[nodiscard]] decltype(auto) Blit(const std::size_t srcIdx, const Cont &destArr, const std::size_t destIdx,
-										  const std::size_t count)
+										  const std::size_t count) const
+		{
+			return Blit(srcIdx, Array(destArr.Data.begin(), destArr.Data.end(), Data.get_allocator()), destIdx, count);
+		}
+
+		[[nodiscard]] Array Blit(const std::size_t srcIdx, Array &&destArr, const std::size_t destIdx,
+								 const std::size_t count) const
 		{
 			const std::size_t n1 = std::distance(Data.begin() + srcIdx, Data.end());
 			const std::size_t n2 = std::distance(destArr.Data.begin() + destIdx, destArr.Data.end());
 			if (n1 < count || n2 < count)
 				throw __Func_Out_Of_Range_Exception__;
-			Array buf(destArr.Data);
-			std::copy_n(Data.begin() + srcIdx, count, buf.Data.begin() + destIdx);
-			return buf;
+			std::copy_n(Data.begin() + srcIdx, count, destArr.Data.begin() + destIdx);
+			return std::move(destArr);
 		}
 
 		template <typename Func>
@@ -532,24 +673,21 @@ namespace CuFunc
 						  { return s.Append(v); });
 		}
 
+		// equal counts keep the order of first occurrence
 		[[nodiscard]] decltype(auto) Count() const
 		{
-			std::unordered_map<ValueType, uint64_t> buf;
+			CuContainer::FlatHashMap<ValueType, std::size_t> index;
+			auto res = NewArray<std::pair<ValueType, uint64_t>>();
 			for (const auto &i : Data)
 			{
-				if (auto p = buf.find(i); p != buf.end())
-				{
-					++p->second;
-					continue;
-				}
-				buf.emplace(i, 1);
+				const auto [it, added] = index.TryEmplace(i, res.Data.size());
+				if (added)
+					res.Data.emplace_back(i, 0);
+				++res.Data[it->second].second;
 			}
-			Array<std::pair<ValueType, uint64_t>> res;
-			for (const auto &it : buf)
-				res.Data.push_back(it);
-			std::sort(res.Data.begin(), res.Data.end(),
-					  [](const auto &a, const auto &b)
-					  { return std::greater<>()(a.second, b.second); });
+			std::stable_sort(res.Data.begin(), res.Data.end(),
+							 [](const auto &a, const auto &b)
+							 { return std::greater<>()(a.second, b.second); });
 			return res;
 		}
 
@@ -561,24 +699,22 @@ namespace CuFunc
 
 		static decltype(auto) Create(const std::size_t &count)
 		{
-			return Array(std::vector(count, ValueType{}));
+			return Array(std::vector<ValueType, AllocatorType>(count));
 		}
 
 		static decltype(auto) Create(const std::size_t &count, const ValueType &val)
 		{
-			return Array(std::vector(count, val));
+			return Array(std::vector<ValueType, AllocatorType>(count, val));
 		}
 
 		[[nodiscard]] decltype(auto) Distinct() const
 		{
-			Array<ValueType> buf;
-			std::unordered_set<ValueType> cache;
+			auto buf = NewArray();
+			CuContainer::FlatHashSet<ValueType> cache;
 			for (const auto &i : Data)
 			{
-				if (cache.find(i) != cache.end())
-					continue;
-				buf.Data.emplace_back(i);
-				cache.emplace(i);
+				if (cache.Insert(i).second)
+					buf.Data.emplace_back(i);
 			}
 			return buf;
 		}
@@ -586,24 +722,47 @@ namespace CuFunc
 		template <typename Func>
 		[[nodiscard]] decltype(auto) DistinctBy(Func &&fn) const
 		{
-			Array<ValueType> buf;
-			std::unordered_set<decltype(fn(Data.at(0)))> cache;
+			auto buf = NewArray();
+			CuContainer::FlatHashSet<std::decay_t<decltype(fn(Data.at(0)))>> cache;
 			for (const auto &i : Data)
 			{
-				const auto v = fn(i);
-				if (cache.find(v) != cache.end())
-					continue;
-				buf.Data.emplace_back(i);
-				cache.emplace(v);
+				if (cache.Insert(fn(i)).second)
+					buf.Data.emplace_back(i);
 			}
 			return buf;
 		}
 
+		// pairs elements up to the shorter length
+		[[nodiscard]] decltype(auto) Dot(const Array &other) const
+		{
+			const auto n = std::min(Length(), other.Length());
+			if constexpr (CuSimd::IsSupported<ValueType>)
+				return CuSimd::Dot(Data.data(), other.Data.data(), n);
+			else
+				return std::transform_reduce(Data.begin(), Data.begin() + n, other.Data.begin(), ValueType{});
+		}
+
 		[[nodiscard]] bool Empty() const
 		{
 			return Data.empty();
 		}
 
+		// distinct elements that do not occur in other
+		[[nodiscard]] decltype(auto) Except(const Array &other) const
+		{
+			auto buf = NewArray();
+			CuContainer::FlatHashSet<ValueType> cache;
+			cache.Reserve(other.Length());
+			for (const auto &i : other.Data)
+				cache.Insert(i);
+			for (const auto &i : Data)
+			{
+				if (cache.Insert(i).second)
+					buf.Data.emplace_back(i);
+			}
+			return buf;
+		}
+
 		[[nodiscard]] decltype(auto) ExactlyOne() const
 		{
 			if (Length() != 1)
@@ -629,21 +788,34 @@ namespace CuFunc
 			return false;
 		}
 
-		[[nodiscard]] decltype(auto) Fill(const std::size_t start, const std::size_t count, const ValueType &val)
+		[[nodiscard]] decltype(auto) Fill(const std::size_t start, const std::size_t count, const ValueType &val) const &
 		{
-			Array buf(Data);
-			std::fill_n(buf.Data.begin() + start, count, val);
-			return buf;
+			return Copy().Fill(start, count, val);
+		}
+
+		[[nodiscard]] Array Fill(const std::size_t start, const std::size_t count, const ValueType &val) &&
+		{
+			std::fill_n(Data.begin() + start, count, val);
+			return std::move(*this);
 		}
 
 		template <typename Func>
-		[[nodiscard]] decltype(auto) Filter(Func &&fn) const
+		[[nodiscard]] decltype(auto) Filter(Func &&fn) const &
 		{
-			Array<ValueType> buf;
+			auto buf = NewArray();
 			std::copy_if(Data.begin(), Data.end(), std::back_inserter(buf.Data), fn);
 			return buf;
 		}
 
+		template <typename Func>
+		[[nodiscard]] Array Filter(Func &&fn) &&
+		{
+			Data.erase(std::remove_if(Data.begin(), Data.end(), [&](const auto &x)
+									  { return !fn(x); }),
+					   Data.end());
+			return std::move(*this);
+		}
+
 		template <typename Func>
 		[[nodiscard]] decltype(auto) Find(Func &&fn) const
 		{
@@ -669,7 +841,10 @@ namespace CuFunc
 		template <typename Func, typename Val>
 		[[nodiscard]] decltype(auto) Fold(Func &&fn, const Val &init) const
 		{
-			return std::reduce(Data.begin(), Data.end(), init, fn);
+			if constexpr (std::is_same_v<std::decay_t<Func>, std::plus<>> && std::is_same_v<Val, ValueType> && CuSimd::IsSupported<ValueType>)
+				return init + CuSimd::Sum(Data.data(), Data.size());
+			else
+				return std::reduce(Data.begin(), Data.end(), init, fn);
 		}
 
 		template <typename Func, typename Val, typename... Args>
@@ -718,26 +893,22 @@ namespace CuFunc
 			return true;
 		}
 
+		// groups are in the order of their first element
 		template <typename Func>
 		[[nodiscard]] decltype(auto) GroupBy(Func &&fn) const
 		{
-			using K = decltype(fn(Data.at(0)));
-			using V = Array<ValueType>;
-			std::unordered_map<K, V> buf;
-			for (std::size_t i = 0; i < Length(); ++i)
+			using K = std::decay_t<decltype(fn(Data.at(0)))>;
+			using V = Array;
+			CuContainer::FlatHashMap<K, std::size_t> index;
+			auto res = NewArray<std::pair<K, V>>();
+			for (const auto &val : Data)
 			{
-				const auto val = Nth(i);
-				const auto key = fn(val);
-				if (const auto it = buf.find(key); it != buf.end())
-				{
-					it->second.Data.emplace_back(val);
-					continue;
-				}
-				buf.emplace(key, Create(1, val));
+				auto key = fn(val);
+				const auto [it, added] = index.TryEmplace(key, res.Data.size());
+				if (added)
+					res.Data.emplace_back(std::move(key), NewArray());
+				res.Data[it->second].second.Data.emplace_back(val);
 			}
-			Array<std::pair<K, V>> res;
-			for (const auto &x : buf)
-				res.Data.push_back(x);
 			return res;
 		}
 
@@ -807,28 +978,75 @@ namespace CuFunc
 			return Data.size();
 		}
 
+		// PlusR, MinusR, MultipliesR and DividesR of the element type run through CuSimd::Transform
 		template <typename Func>
-		[[nodiscard]] decltype(auto) Map(Func &&fn) const
+		[[nodiscard]] decltype(auto) Map(Func &&fn) const &
 		{
-			Array<decltype(fn(Data.at(0)))> buf;
-			std::transform(Data.begin(), Data.end(), std::back_inserter(buf.Data), fn);
-			return buf;
+			if constexpr (__Detail::IsSimdScalarOp<Func, ValueType>)
+			{
+				auto buf = NewArray();
+				buf.Data.resize(Data.size());
+				CuSimd::Transform(Data.data(), fn.Val, buf.Data.data(), Data.size(),
+								  typename __Detail::SimdScalarOp<std::decay_t<Func>, ValueType>::Op{});
+				return buf;
+			}
+			else
+			{
+				auto buf = NewArray<decltype(fn(Data.at(0)))>();
+				std::transform(Data.begin(), Data.end(), std::back_inserter(buf.Data), fn);
+				return buf;
+			}
 		}
 
+		// transforms in place when fn keeps the element type
+		template <typename Func>
+		[[nodiscard]] decltype(auto) Map(Func &&fn) &&
+		{
+			if constexpr (__Detail::IsSimdScalarOp<Func, ValueType>)
+			{
+				CuSimd::Transform(Data.data(), fn.Val, Data.data(), Data.size(),
+								  typename __Detail::SimdScalarOp<std::decay_t<Func>, ValueType>::Op{});
+				return Array(std::move(*this));
+			}
+			else if constexpr (std::is_same_v<decltype(fn(Data.at(0))), ValueType>)
+			{
+				std::transform(Data.begin(), Data.end(), Data.begin(), fn);
+				return Array(std::move(*this));
+			}
+			else
+			{
+				return std::as_const(*this).Map(fn);
+			}
+		}
+
+		// Plus, Minus, Multiplies and Divides over two arrays of the element type run through CuSimd::Transform
 		template <typename Func, typename... Arrays>
 		[[nodiscard]] decltype(auto) Map(Func &&fn, Arrays &&...arrays) const
 		{
-			Array<decltype(fn(Data.at(0), MapNth(0, arrays)...))> buf;
-			const auto n = std::min({Length(), MapLength(arrays)...});
-			for (std::size_t i = 0; i < n; ++i)
-				buf.Data.emplace_back(fn(Nth(i), MapNth(i, arrays)...));
-			return buf;
+			if constexpr (sizeof...(Arrays) == 1 && (std::is_same_v<std::decay_t<Arrays>, Array> && ...) &&
+						  CuSimd::IsVectorOp<std::decay_t<Func>, ValueType>)
+			{
+				const auto &other = (arrays, ...);
+				const auto n = std::min(Length(), other.Length());
+				auto buf = NewArray();
+				buf.Data.resize(n);
+				CuSimd::Transform(Data.data(), other.Data.data(), buf.Data.data(), n, fn);
+				return buf;
+			}
+			else
+			{
+				auto buf = NewArray<decltype(fn(Data.at(0), MapNth(0, arrays)...))>();
+				const auto n = std::min({Length(), MapLength(arrays)...});
+				for (std::size_t i = 0; i < n; ++i)
+					buf.Data.emplace_back(fn(Nth(i), MapNth(i, arrays)...));
+				return buf;
+			}
 		}
 
 		template <typename Func>
 		[[nodiscard]] decltype(auto) Mapi(Func &&fn) const
 		{
-			Array<decltype(fn(0, Data.at(0)))> buf;
+			auto buf = NewArray<decltype(fn(0, Data.at(0)))>();
 			std::transform(Data.begin(), Data.end(), std::back_inserter(buf.Data),
 						   [&, i = static_cast<std::size_t>(0)](const auto &it) mutable
 						   { return fn(i++, it); });
@@ -838,7 +1056,7 @@ namespace CuFunc
 		template <typename Func, typename... Arrays>
 		[[nodiscard]] decltype(auto) Mapi(Func &&fn, Arrays &&...arrays) const
 		{
-			Array<decltype(fn(0, Data.at(0), MapNth(0, arrays)...))> buf;
+			auto buf = NewArray<decltype(fn(0, Data.at(0), MapNth(0, arrays)...))>();
 			std::transform(Data.begin(), Data.end(), std::back_inserter(buf.Data),
 						   [&, i = static_cast<std::size_t>(0)](const auto &it) mutable
 						   {
@@ -852,24 +1070,29 @@ namespace CuFunc
 		{
 			if (Empty())
 				throw __Func_Empty_Seq_Exception__;
-			return *std::max_element(Data.begin(), Data.end());
+			if constexpr (CuSimd::IsSupported<ValueType>)
+				return Data[CuSimd::ArgMax(Data.data(), Data.size())];
+			else
+				return *std::max_element(Data.begin(), Data.end());
 		}
 
+		// fn runs once per element, the first of equal maxima wins
 		template <typename Func>
 		[[nodiscard]] decltype(auto) MaxBy(Func &&fn) const
 		{
 			if (Empty())
 				throw __Func_Empty_Seq_Exception__;
-			return *std::max_element(Data.begin(), Data.end(),
-									 [&](const auto &a, const auto &b)
-									 { return std::less<>{}(fn(a), fn(b)); });
+			return Data[BestByKey(fn, std::less<>{})];
 		}
 
 		[[nodiscard]] decltype(auto) Min() const
 		{
 			if (Empty())
 				throw __Func_Empty_Seq_Exception__;
-			return *std::min_element(Data.begin(), Data.end());
+			if constexpr (CuSimd::IsSupported<ValueType>)
+				return Data[CuSimd::ArgMin(Data.data(), Data.size())];
+			else
+				return *std::min_element(Data.begin(), Data.end());
 		}
 
 		template <typename Func>
@@ -877,9 +1100,7 @@ namespace CuFunc
 		{
 			if (Empty())
 				throw __Func_Empty_Seq_Exception__;
-			return *std::min_element(Data.begin(), Data.end(),
-									 [&](const auto &a, const auto &b)
-									 { return std::less<>()(fn(a), fn(b)); });
+			return Data[BestByKey(fn, std::greater<>{})];
 		}
 
 		[[nodiscard]] decltype(auto) Nth(const std::size_t &index) const
@@ -887,9 +1108,15 @@ namespace CuFunc
 			return Data.at(index);
 		}
 
+		// needs Function/FunctionParallel.hpp, the array must outlive the adapter
+		[[nodiscard]] decltype(auto) Par(const std::size_t threshold = DefaultParallelThreshold) const
+		{
+			return ParArray<ValueType, AllocatorType>(*this, threshold);
+		}
+
 		[[nodiscard]] decltype(auto) Pairwise() const
 		{
-			Array<std::pair<ValueType, ValueType>> buf;
+			auto buf = NewArray<std::pair<ValueType, ValueType>>();
 			if (Length() < 2)
 				return buf;
 			for (std::size_t i = 1; i < Length(); ++i)
@@ -899,10 +1126,22 @@ namespace CuFunc
 			return buf;
 		}
 
+		// views borrow Data, they stay valid until the array is destroyed or reallocates
+		[[nodiscard]] decltype(auto) PairwiseView() const
+		{
+			auto buf = NewArray<std::span<const ValueType, 2>>();
+			if (Length() < 2)
+				return buf;
+			buf.Data.reserve(Length() - 1);
+			for (std::size_t i = 1; i < Length(); ++i)
+				buf.Data.emplace_back(Data.data() + i - 1, 2);
+			return buf;
+		}
+
 		template <typename Func>
 		[[nodiscard]] decltype(auto) Partition(Func &&fn)
 		{
-			std::pair<Array<ValueType>, Array<ValueType>> buf;
+			std::pair buf{NewArray(), NewArray()};
 			std::partition_copy(Data.begin(), Data.end(), std::back_inserter(buf.first.Data),
 								std::back_inserter(buf.second.Data), fn);
 			return buf;
@@ -911,7 +1150,8 @@ namespace CuFunc
 		template <typename Func>
 		[[nodiscard]] decltype(auto) Permute(Func &&fn)
 		{
-			auto buf = Array<std::optional<ValueType>>::Create(Length());
+			auto buf = NewArray<std::optional<ValueType>>();
+			buf.Data.resize(Length());
 			for (std::size_t i = 0; i < Length(); ++i)
 			{
 				const auto p = fn(i);
@@ -945,7 +1185,7 @@ namespace CuFunc
 
 		static decltype(auto) Range(const ValueType &init, const std::size_t &count, const ValueType &step)
 		{
-			Array<ValueType> buf;
+			Array buf(AllocatorType{});
 			std::generate_n(std::back_inserter(buf.Data), count, [&, i = init]() mutable
 							{
             const auto v = i;
@@ -975,17 +1215,23 @@ namespace CuFunc
 			return std::reduce(Data.rbegin() + 1, Data.rend(), *Data.rbegin(), fn);
 		}
 
-		[[nodiscard]] decltype(auto) Rev() const
+		[[nodiscard]] decltype(auto) Rev() const &
 		{
-			Array<ValueType> buf;
+			auto buf = NewArray();
 			std::copy(Data.rbegin(), Data.rend(), std::back_inserter(buf.Data));
 			return buf;
 		}
 
+		[[nodiscard]] Array Rev() &&
+		{
+			std::reverse(Data.begin(), Data.end());
+			return std::move(*this);
+		}
+
 		template <typename Func, typename Val>
 		[[nodiscard]] decltype(auto) Scan(Func &&fn, const Val &init) const
 		{
-			Array<Val> buf;
+			auto buf = NewArray<Val>();
 			buf.Data.push_back(init);
 			std::for_each(Data.begin(), Data.end(), [&](const auto &it)
 						  { buf.Data.push_back(fn(buf.Last(), it)); });
@@ -995,7 +1241,7 @@ namespace CuFunc
 		template <typename Func, typename Val>
 		[[nodiscard]] decltype(auto) ScanBack(Func &&fn, const Val &init) const
 		{
-			Array<Val> buf;
+			auto buf = NewArray<Val>();
 			buf.Data.push_back(init);
 			std::for_each(Data.rbegin(), Data.rend(),
 						  [&](const auto &it)
@@ -1003,11 +1249,15 @@ namespace CuFunc
 			return buf;
 		}
 
-		[[nodiscard]] decltype(auto) Set(const std::size_t idx, const ValueType &val) const
+		[[nodiscard]] decltype(auto) Set(const std::size_t idx, const ValueType &val) const &
 		{
-			Array buf(Data);
-			buf.Data.at(idx) = val;
-			return buf;
+			return Copy().Set(idx, val);
+		}
+
+		[[nodiscard]] Array Set(const std::size_t idx, const ValueType &val) &&
+		{
+			Data.at(idx) = val;
+			return std::move(*this);
 		}
 
 		[[nodiscard]] decltype(auto) SetInPlace(const std::size_t idx, const ValueType &val)
@@ -1022,47 +1272,82 @@ namespace CuFunc
 			return Array::Create(1, init);
 		}
 
-		[[nodiscard]] decltype(auto) Skip(const std::size_t &count) const
+		[[nodiscard]] decltype(auto) Skip(const std::size_t &count) const &
 		{
 			if (count > Length())
 				throw __Func_Out_Of_Range_Exception__;
-			Array<ValueType> buf;
+			auto buf = NewArray();
 			std::copy(Data.begin() + count, Data.end(), std::back_inserter(buf.Data));
 			return buf;
 		}
 
+		[[nodiscard]] Array Skip(const std::size_t &count) &&
+		{
+			if (count > Length())
+				throw __Func_Out_Of_Range_Exception__;
+			Data.erase(Data.begin(), Data.begin() + count);
+			return std::move(*this);
+		}
+
+		[[nodiscard]] std::span<const ValueType> SkipView(const std::size_t count) const
+		{
+			if (count > Length())
+				throw __Func_Out_Of_Range_Exception__;
+			return std::span<const ValueType>(Data).subspan(count);
+		}
+
 		template <typename Func>
-		[[nodiscard]] decltype(auto) SkipWhile(Func &&fn) const
+		[[nodiscard]] decltype(auto) SkipWhile(Func &&fn) const &
 		{
-			Array<ValueType> buf;
+			auto buf = NewArray();
 			const auto pos = std::find_if_not(Data.begin(), Data.end(), fn);
 			std::copy(pos, Data.end(), std::back_inserter(buf.Data));
 			return buf;
 		}
 
-		[[nodiscard]] decltype(auto) Sort() const
+		template <typename Func>
+		[[nodiscard]] Array SkipWhile(Func &&fn) &&
 		{
-			Array buf(Data);
-			std::sort(buf.Data.begin(), buf.Data.end());
-			return buf;
+			Data.erase(Data.begin(), std::find_if_not(Data.begin(), Data.end(), fn));
+			return std::move(*this);
+		}
+
+		[[nodiscard]] decltype(auto) Sort() const &
+		{
+			return Copy().Sort();
+		}
+
+		[[nodiscard]] Array Sort() &&
+		{
+			std::sort(Data.begin(), Data.end());
+			return std::move(*this);
 		}
 
 		template <typename Func>
-		[[nodiscard]] decltype(auto) SortBy(Func &&fn) const
+		[[nodiscard]] decltype(auto) SortBy(Func &&fn) const &
 		{
-			Array buf(Data);
-			std::sort(buf.Data.begin(), buf.Data.end(),
-					  [&](const auto &a, const auto &b)
-					  { return std::less<>()(fn(a), fn(b)); });
-			return buf;
+			return Copy().SortBy(fn);
 		}
 
+		// keys are computed once per element and sorted with their index, equal keys keep their order
 		template <typename Func>
-		[[nodiscard]] decltype(auto) SortWith(Func &&fn) const
+		[[nodiscard]] Array SortBy(Func &&fn) &&
 		{
-			Array buf(Data);
-			std::sort(buf.Data.begin(), buf.Data.end(), fn);
-			return buf;
+			SortByKey(fn);
+			return std::move(*this);
+		}
+
+		template <typename Func>
+		[[nodiscard]] decltype(auto) SortWith(Func &&fn) const &
+		{
+			return Copy().SortWith(fn);
+		}
+
+		template <typename Func>
+		[[nodiscard]] Array SortWith(Func &&fn) &&
+		{
+			std::sort(Data.begin(), Data.end(), fn);
+			return std::move(*this);
 		}
 
 		[[nodiscard]] decltype(auto) SortInPlace()
@@ -1074,8 +1359,7 @@ namespace CuFunc
 		template <typename Func>
 		[[nodiscard]] decltype(auto) SortByInPlace(Func &&fn)
 		{
-			std::sort(Data.begin(), Data.end(), [&](const auto &a, const auto &b)
-					  { return std::less<>()(fn(a), fn(b)); });
+			SortByKey(fn);
 			return *this;
 		}
 
@@ -1086,19 +1370,39 @@ namespace CuFunc
 			return *this;
 		}
 
-		[[nodiscard]] decltype(auto) Sub(const std::size_t start, const std::size_t size) const
+		[[nodiscard]] decltype(auto) Sub(const std::size_t start, const std::size_t size) const &
 		{
 
 			if (start + size > Length())
 				throw __Func_Out_Of_Range_Exception__;
-			Array<ValueType> buf;
+			auto buf = NewArray();
 			std::copy_n(Data.begin() + start, size, std::back_inserter(buf.Data));
 			return buf;
 		}
 
+		[[nodiscard]] Array Sub(const std::size_t start, const std::size_t size) &&
+		{
+			if (start + size > Length())
+				throw __Func_Out_Of_Range_Exception__;
+			Data.erase(Data.begin() + start + size, Data.end());
+			Data.erase(Data.begin(), Data.begin() + start);
+			return std::move(*this);
+		}
+
+		[[nodiscard]] std::span<const ValueType> SubView(const std::size_t start, const std::size_t size) const
+		{
+			if (start + size > Length())
+				throw __Func_Out_Of_Range_Exception__;
+			return std::span<const ValueType>(Data).subspan(start, size);
+		}
+
+		// float, double and int32 sums are vectorized and may differ from a sequential sum in the last bits
 		[[nodiscard]] decltype(auto) Sum() const
 		{
-			return std::reduce(Data.begin(), Data.end());
+			if constexpr (CuSimd::IsSupported<ValueType>)
+				return CuSimd::Sum(Data.data(), Data.size());
+			else
+				return std::reduce(Data.begin(), Data.end());
 		}
 
 		template <typename Func>
@@ -1107,33 +1411,70 @@ namespace CuFunc
 			return Map(fn).Sum();
 		}
 
-		[[nodiscard]] decltype(auto) Take(const std::size_t &count) const
+		[[nodiscard]] decltype(auto) Take(const std::size_t &count) const &
 		{
 			if (count > Length())
 				throw __Func_Out_Of_Range_Exception__;
-			Array<ValueType> buf;
+			auto buf = NewArray();
 			std::copy_n(Data.begin(), count, std::back_inserter(buf.Data));
 			return buf;
 		}
 
+		[[nodiscard]] Array Take(const std::size_t &count) &&
+		{
+			if (count > Length())
+				throw __Func_Out_Of_Range_Exception__;
+			Data.erase(Data.begin() + count, Data.end());
+			return std::move(*this);
+		}
+
+		[[nodiscard]] std::span<const ValueType> TakeView(const std::size_t count) const
+		{
+			if (count > Length())
+				throw __Func_Out_Of_Range_Exception__;
+			return std::span<const ValueType>(Data).first(count);
+		}
+
 		template <typename Func>
-		[[nodiscard]] decltype(auto) TakeWhile(Func &&fn) const
+		[[nodiscard]] decltype(auto) TakeWhile(Func &&fn) const &
 		{
-			Array<ValueType> buf;
+			auto buf = NewArray();
 			const auto pos = std::find_if_not(Data.begin(), Data.end(), fn);
 			std::copy(Data.begin(), pos, std::back_inserter(buf.Data));
 			return buf;
 		}
 
-		[[nodiscard]] decltype(auto) Tail() const
+		template <typename Func>
+		[[nodiscard]] Array TakeWhile(Func &&fn) &&
+		{
+			Data.erase(std::find_if_not(Data.begin(), Data.end(), fn), Data.end());
+			return std::move(*this);
+		}
+
+		[[nodiscard]] decltype(auto) Tail() const &
 		{
 			if (Empty())
 				throw __Func_One_Element_Exception__;
-			Array<ValueType> buf;
+			auto buf = NewArray();
 			std::copy(Data.begin() + 1, Data.end(), std::back_inserter(buf.Data));
 			return buf;
 		}
 
+		[[nodiscard]] Array Tail() &&
+		{
+			if (Empty())
+				throw __Func_One_Element_Exception__;
+			Data.erase(Data.begin());
+			return std::move(*this);
+		}
+
+		[[nodiscard]] std::span<const ValueType> TailView() const
+		{
+			if (Empty())
+				throw __Func_One_Element_Exception__;
+			return std::span<const ValueType>(Data).subspan(1);
+		}
+
 		template <typename Func>
 		[[nodiscard]] decltype(auto) TryFind(Func &&fn) const
 		{
@@ -1167,17 +1508,23 @@ namespace CuFunc
 			return Type{};
 		}
 
-		[[nodiscard]] decltype(auto) Truncate(const std::size_t &count) const
+		[[nodiscard]] decltype(auto) Truncate(const std::size_t &count) const &
 		{
-			Array<ValueType> buf;
+			auto buf = NewArray();
 			std::copy_n(Data.begin(), std::min(count, Length()), std::back_inserter(buf.Data));
 			return buf;
 		}
 
+		[[nodiscard]] Array Truncate(const std::size_t &count) &&
+		{
+			Data.erase(Data.begin() + std::min(count, Length()), Data.end());
+			return std::move(*this);
+		}
+
 		template <typename Func, typename Stat>
 		static decltype(auto) Unfold(Func &&fn, Stat &&status)
 		{
-			Array<ValueType> buf;
+			Array buf(AllocatorType{});
 			for (auto curSt = status;;)
 			{
 				auto tmp = fn(curSt);
@@ -1192,22 +1539,34 @@ namespace CuFunc
 
 		[[nodiscard]] decltype(auto) Windowed(const std::size_t &count) const
 		{
-			Array<Array<ValueType>> buf;
+			auto buf = NewArray<Array>();
 			if (Length() < count)
 				return buf;
 			for (int i = 0; i <= Length() - count; ++i)
 			{
-				Array<ValueType> tmp;
+				auto tmp = NewArray();
 				std::copy_n(Data.begin() + i, count, std::back_inserter(tmp.Data));
-				buf.Data.push_back(tmp);
+				buf.Data.push_back(std::move(tmp));
 			}
 			return buf;
 		}
 
+		// one span per window instead of count copied elements
+		[[nodiscard]] decltype(auto) WindowedView(const std::size_t count) const
+		{
+			auto buf = NewArray<std::span<const ValueType>>();
+			if (Length() < count)
+				return buf;
+			buf.Data.reserve(Length() - count + 1);
+			for (std::size_t i = 0; i <= Length() - count; ++i)
+				buf.Data.emplace_back(Data.data() + i, count);
+			return buf;
+		}
+
 		template <typename... Args>
 		[[nodiscard]] decltype(auto) Zip(Args &&...args) const
 		{
-			Array<decltype(AsTuple(Nth(0), MapNth(0, args)...))> buf;
+			auto buf = NewArray<decltype(AsTuple(Nth(0), MapNth(0, args)...))>();
 			const auto n = std::min({Length(), MapLength(args)...});
 			for (std::size_t i = 0; i < n; ++i)
 			{
@@ -1217,6 +1576,43 @@ namespace CuFunc
 		}
 
 	private:
+		// the implicit copy goes through select_on_container_copy_construction, which drops a pmr resource
+		[[nodiscard]] Array Copy() const
+		{
+			return Array(Data.begin(), Data.end(), Data.get_allocator());
+		}
+
+		template <typename Func>
+		void SortByKey(Func &&fn)
+		{
+			using K = std::decay_t<decltype(fn(Data.at(0)))>;
+			using Keyed = std::pair<K, std::size_t>;
+			std::vector<Keyed, typename std::allocator_traits<AllocatorType>::template rebind_alloc<Keyed>> keys(Data.get_allocator());
+			keys.reserve(Data.size());
+			for (std::size_t i = 0; i < Data.size(); ++i)
+				keys.emplace_back(fn(Data[i]), i);
+			std::sort(keys.begin(), keys.end(), __Detail::KeyIndexLess{});
+			__Detail::ApplyKeyOrder(Data, keys);
+		}
+
+		// index of the first element whose key no other key beats under better
+		template <typename Func, typename Better>
+		[[nodiscard]] std::size_t BestByKey(Func &&fn, Better better) const
+		{
+			std::size_t best = 0;
+			auto bestKey = fn(Data[0]);
+			for (std::size_t i = 1; i < Data.size(); ++i)
+			{
+				auto key = fn(Data[i]);
+				if (better(bestKey, key))
+				{
+					bestKey = std::move(key);
+					best = i;
+				}
+			}
+			return best;
+		}
+
 		template <typename... Args>
 		[[nodiscard]] static decltype(auto) AsTuple(Args &&...args)
 		{
@@ -1235,6 +1631,376 @@ namespace CuFunc
 			return arg.Length();
 		}
 	};
+
+	namespace pmr
+	{
+		// runs a whole pipeline out of one memory_resource, e.g. a request scoped std::pmr::monotonic_buffer_resource
+		template <typename T>
+		using Array = CuFunc::Array<T, std::pmr::polymorphic_allocator<T>>;
+
+		// forwards to the upstream resource and counts what passes through, e.g. to measure the allocations of a pipeline
+		class CountingResource : public std::pmr::memory_resource
+		{
+		public:
+			explicit CountingResource(std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+				: upstream(upstream)
+			{
+			}
+
+			[[nodiscard]] std::size_t Allocations() const
+			{
+				return allocations.load(std::memory_order_relaxed);
+			}
+
+			[[nodiscard]] std::size_t Deallocations() const
+			{
+				return deallocations.load(std::memory_order_relaxed);
+			}
+
+			[[nodiscard]] std::size_t AllocatedBytes() const
+			{
+				return allocatedBytes.load(std::memory_order_relaxed);
+			}
+
+			[[nodiscard]] std::size_t LiveBytes() const
+			{
+				return liveBytes.load(std::memory_order_relaxed);
+			}
+
+			[[nodiscard]] std::size_t PeakBytes() const
+			{
+				return peakBytes.load(std::memory_order_relaxed);
+			}
+
+			// clears the counters, the peak restarts from the bytes still live
+			void Reset()
+			{
+				allocations.store(0, std::memory_order_relaxed);
+				deallocations.store(0, std::memory_order_relaxed);
+				allocatedBytes.store(0, std::memory_order_relaxed);
+				peakBytes.store(liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			}
+
+		private:
+			std::pmr::memory_resource *upstream;
+			std::atomic<std::size_t> allocations = 0;
+			std::atomic<std::size_t> deallocations = 0;
+			std::atomic<std::size_t> allocatedBytes = 0;
+			std::atomic<std::size_t> liveBytes = 0;
+			std::atomic<std::size_t> peakBytes = 0;
+
+			void *do_allocate(const std::size_t bytes, const std::size_t alignment) override
+			{
+				auto *p = upstream->allocate(bytes, alignment);
+				allocations.fetch_add(1, std::memory_order_relaxed);
+				allocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+				const auto live = liveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+				auto peak = peakBytes.load(std::memory_order_relaxed);
+				while (live > peak && !peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+					;
+				return p;
+			}
+
+			void do_deallocate(void *p, const std::size_t bytes, const std::size_t alignment) override
+			{
+				upstream->deallocate(p, bytes, alignment);
+				deallocations.fetch_add(1, std::memory_order_relaxed);
+				liveBytes.fetch_sub(bytes, std::memory_order_relaxed);
+			}
+
+			[[nodiscard]] bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+			{
+				return this == &other;
+			}
+		};
+	} // namespace pmr
+
+	// lazy sequence, stages are fused into one pass that runs when a terminal operation is called.
+	// Gen is called as gen(sink) and must stop as soon as sink returns false
+	template <typename T, typename Gen>
+	struct Seq
+	{
+		using ValueType = T;
+
+		Gen Generator;
+
+		explicit Seq(Gen gen) : Generator(std::move(gen))
+		{
+		}
+
+		template <typename Func>
+		[[nodiscard]] decltype(auto) Choose(Func fn) const
+		{
+			using R = typename std::decay_t<std::invoke_result_t<Func &, const ValueType &>>::value_type;
+			return Make<R>([gen = Generator, fn](auto &&sink)
+						   { gen([&](auto &&v)
+								 {
+						auto res = fn(std::forward<decltype(v)>(v));
+						return !res.has_value() || sink(std::move(*res)); }); });
+		}
+
+		// fn returns a container or an Array
+		template <typename Func>
+		[[nodiscard]] decltype(auto) Collect(Func fn) const
+		{
+			using C = std::decay_t<std::invoke_result_t<Func &, const ValueType &>>;
+			using R = __Detail::CollectValue<C>;
+			return Make<R>([gen = Generator, fn](auto &&sink)
+						   { gen([&](auto &&v)
+								 {
+						C res = fn(std::forward<decltype(v)>(v));
+						for (auto &&it : __Detail::CollectRange(res))
+							if (!sink(std::move(it)))
+								return false;
+						return true; }); });
+		}
+
+		template <typename Func>
+		[[nodiscard]] decltype(auto) Filter(Func fn) const
+		{
+			return Make<ValueType>([gen = Generator, fn](auto &&sink)
+								   { gen([&](auto &&v)
+										 { return !fn(std::as_const(v)) || sink(std::forward<decltype(v)>(v)); }); });
+		}
+
+		template <typename Func>
+		[[nodiscard]] decltype(auto) Map(Func fn) const
+		{
+			using R = std::decay_t<std::invoke_result_t<Func &, const ValueType &>>;
+			return Make<R>([gen = Generator, fn](auto &&sink)
+						   { gen([&](auto &&v)
+								 { return sink(fn(std::forward<decltype(v)>(v))); }); });
+		}
+
+		template <typename Func>
+		[[nodiscard]] decltype(auto) Mapi(Func fn) const
+		{
+			using R = std::decay_t<std::invoke_result_t<Func &, std::size_t, const ValueType &>>;
+			return Make<R>([gen = Generator, fn](auto &&sink)
+						   {
+				std::size_t i = 0;
+				gen([&](auto &&v)
+					{ return sink(fn(i++, std::forward<decltype(v)>(v))); }); });
+		}
+
+		[[nodiscard]] decltype(auto) Skip(const std::size_t count) const
+		{
+			return Make<ValueType>([gen = Generator, count](auto &&sink)
+								   {
+				std::size_t i = 0;
+				gen([&](auto &&v)
+					{ return i++ < count || sink(std::forward<decltype(v)>(v)); }); });
+		}
+
+		template <typename Func>
+		[[nodiscard]] decltype(auto) SkipWhile(Func fn) const
+		{
+			return Make<ValueType>([gen = Generator, fn](auto &&sink)
+								   {
+				bool skipping = true;
+				gen([&](auto &&v)
+					{
+					if (skipping && fn(std::as_const(v)))
+						return true;
+					skipping = false;
+					return sink(std::forward<decltype(v)>(v)); }); });
+		}
+
+		// like Array::Truncate, the length of the source is not known up front
+		[[nodiscard]] decltype(auto) Take(const std::size_t count) const
+		{
+			return Make<ValueType>([gen = Generator, count](auto &&sink)
+								   {
+				if (count == 0)
+					return;
+				std::size_t i = 0;
+				gen([&](auto &&v)
+					{ return sink(std::forward<decltype(v)>(v)) && ++i < count; }); });
+		}
+
+		template <typename Func>
+		[[nodiscard]] decltype(auto) TakeWhile(Func fn) const
+		{
+			return Make<ValueType>([gen = Generator, fn](auto &&sink)
+								   { gen([&](auto &&v)
+										 { return fn(std::as_const(v)) && sink(std::forward<decltype(v)>(v)); }); });
+		}
+
+		[[nodiscard]] decltype(auto) Average() const
+		{
+			std::size_t n = 0;
+			auto sum = ValueType{};
+			Iter([&](const auto &v)
+				 {
+				sum = sum + v;
+				++n; });
+			if (n == 0)
+				throw __Func_Empty_Seq_Exception__;
+			return sum / static_cast<ValueType>(n);
+		}
+
+		template <typename Func>
+		[[nodiscard]] bool Exists(Func &&fn) const
+		{
+			return TryFind(fn).has_value();
+		}
+
+		template <typename Func>
+		[[nodiscard]] decltype(auto) Find(Func &&fn) const
+		{
+			auto res = TryFind(fn);
+			if (!res.has_value())
+				throw __Func_Not_Found_Exception__;
+			return ValueType(std::move(*res));
+		}
+
+		template <typename Func, typename Val>
+		[[nodiscard]] decltype(auto) Fold(Func &&fn, const Val &init) const
+		{
+			auto st = init;
+			Iter([&](auto &&v)
+				 { st = fn(std::move(st), std::forward<decltype(v)>(v)); });
+			return st;
+		}
+
+		template <typename Func>
+		[[nodiscard]] bool ForAll(Func &&fn) const
+		{
+			bool empty = true;
+			bool res = true;
+			Generator([&](const auto &v)
+					  {
+				empty = false;
+				res = fn(v);
+				return res; });
+			if (empty)
+				throw __Func_Empty_Seq_Exception__;
+			return res;
+		}
+
+		[[nodiscard]] decltype(auto) Head() const
+		{
+			auto res = TryHead();
+			if (!res.has_value())
+				throw __Func_One_Element_Exception__;
+			return ValueType(std::move(*res));
+		}
+
+		template <typename Func>
+		void Iter(Func &&fn) const
+		{
+			Generator([&](auto &&v)
+					  {
+				fn(std::forward<decltype(v)>(v));
+				return true; });
+		}
+
+		[[nodiscard]] std::size_t Length() const
+		{
+			std::size_t n = 0;
+			Generator([&](const auto &)
+					  {
+				++n;
+				return true; });
+			return n;
+		}
+
+		[[nodiscard]] decltype(auto) Max() const
+		{
+			return Reduce([](auto &&a, auto &&b)
+						  { return std::less<>{}(a, b) ? std::forward<decltype(b)>(b) : std::forward<decltype(a)>(a); });
+		}
+
+		[[nodiscard]] decltype(auto) Min() const
+		{
+			return Reduce([](auto &&a, auto &&b)
+						  { return std::less<>{}(b, a) ? std::forward<decltype(b)>(b) : std::forward<decltype(a)>(a); });
+		}
+
+		template <typename Func>
+		[[nodiscard]] decltype(auto) Reduce(Func &&fn) const
+		{
+			std::optional<ValueType> st{};
+			Iter([&](auto &&v)
+				 {
+				if (st.has_value())
+					*st = fn(std::move(*st), std::forward<decltype(v)>(v));
+				else
+					st.emplace(std::forward<decltype(v)>(v)); });
+			if (!st.has_value())
+				throw __Func_Empty_Seq_Exception__;
+			return ValueType(std::move(*st));
+		}
+
+		[[nodiscard]] decltype(auto) Sum() const
+		{
+			return Fold(std::plus<>{}, ValueType{});
+		}
+
+		[[nodiscard]] decltype(auto) ToArray() const
+		{
+			Array<ValueType> buf;
+			Iter([&](auto &&v)
+				 { buf.Data.emplace_back(std::forward<decltype(v)>(v)); });
+			return buf;
+		}
+
+		[[nodiscard]] std::vector<ValueType> ToVector() const
+		{
+			return ToArray().Data;
+		}
+
+		template <typename Func>
+		[[nodiscard]] decltype(auto) TryFind(Func &&fn) const
+		{
+			std::optional<ValueType> res{};
+			Generator([&](auto &&v)
+					  {
+				if (!fn(std::as_const(v)))
+					return true;
+				res.emplace(std::forward<decltype(v)>(v));
+				return false; });
+			return res;
+		}
+
+		[[nodiscard]] decltype(auto) TryHead() const
+		{
+			std::optional<ValueType> res{};
+			Generator([&](auto &&v)
+					  {
+				res.emplace(std::forward<decltype(v)>(v));
+				return false; });
+			return res;
+		}
+
+	private:
+		template <typename R, typename G>
+		[[nodiscard]] static decltype(auto) Make(G gen)
+		{
+			return Seq<R, G>(std::move(gen));
+		}
+	};
+
+	// the range must outlive the sequence
+	template <typename It>
+	[[nodiscard]] decltype(auto) AsSeq(It begin, It end)
+	{
+		using T = std::decay_t<decltype(*begin)>;
+		auto gen = [begin, end](auto &&sink)
+		{
+			for (auto it = begin; it != end; ++it)
+				if (!sink(*it))
+					return;
+		};
+		return Seq<T, decltype(gen)>(std::move(gen));
+	}
+
+	// lazy pipelines over the span views of Array
+	template <typename T, std::size_t Extent>
+	[[nodiscard]] decltype(auto) AsSeq(const std::span<T, Extent> view)
+	{
+		return AsSeq(view.begin(), view.end());
+	}
 } // namespace Func
 
 #undef __Func_Ex__
@@ -0,0 +1,244 @@
+#pragma once
+
+#include "Function.hpp"
+#include "../Parallel/Parallel.hpp"
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace CuFunc
+{
+	// routes the heavy combinators through Parallel:: once the array reaches Threshold elements,
+	// results keep the element order and exceptions of the sequential Array versions
+	template <typename T, typename Alloc>
+	struct ParArray
+	{
+		using ValueType = T;
+		using AllocatorType = Alloc;
+
+		const Array<ValueType, AllocatorType> &Source;
+		std::size_t Threshold;
+
+		explicit ParArray(const Array<ValueType, AllocatorType> &source, const std::size_t threshold = DefaultParallelThreshold)
+			: Source(source), Threshold(threshold)
+		{
+		}
+
+		[[nodiscard]] bool UseParallel() const
+		{
+			return Source.Length() >= Threshold && Source.Length() > 1;
+		}
+
+		[[nodiscard]] decltype(auto) Average() const
+		{
+			if (Source.Empty())
+				return Source.Average();
+			return Sum() / static_cast<ValueType>(Source.Length());
+		}
+
+		template <typename Func>
+		[[nodiscard]] bool Exists(Func &&fn) const
+		{
+			if (!UseParallel())
+				return Source.Exists(fn);
+			return Parallel::AnyOf(Source.Data.begin(), Source.Data.end(), fn);
+		}
+
+		template <typename Func>
+		[[nodiscard]] decltype(auto) Filter(Func &&fn) const
+		{
+			if (!UseParallel())
+				return Source.Filter(fn);
+
+			const auto mask = Mask(fn);
+			auto buf = Source.NewArray();
+			buf.Data.reserve(std::count(mask.begin(), mask.end(), std::uint8_t{1}));
+			for (std::size_t i = 0; i < mask.size(); ++i)
+				if (mask[i])
+					buf.Data.push_back(Source.Data[i]);
+			return buf;
+		}
+
+		template <typename Func>
+		[[nodiscard]] decltype(auto) ForAll(Func &&fn) const
+		{
+			if (!UseParallel())
+				return Source.ForAll(fn);
+			return Parallel::AllOf(Source.Data.begin(), Source.Data.end(), fn);
+		}
+
+		template <typename Func>
+		[[nodiscard]] decltype(auto) GroupBy(Func &&fn) const
+		{
+			if (!UseParallel())
+				return Source.GroupBy(fn);
+
+			using K = std::decay_t<decltype(fn(Source.Data.at(0)))>;
+			using V = Array<ValueType, AllocatorType>;
+			const auto keys = Map(fn);
+			CuContainer::FlatHashMap<K, std::size_t> index;
+			auto res = Source.template NewArray<std::pair<K, V>>();
+			for (std::size_t i = 0; i < Source.Length(); ++i)
+			{
+				const auto [it, added] = index.TryEmplace(keys.Data[i], res.Data.size());
+				if (added)
+					res.Data.emplace_back(keys.Data[i], Source.NewArray());
+				res.Data[it->second].second.Data.emplace_back(Source.Data[i]);
+			}
+			return res;
+		}
+
+		// fn may run concurrently and in any order
+		template <typename Func>
+		void Iter(Func &&fn) const
+		{
+			if (!UseParallel())
+				return Source.Iter(fn);
+			Parallel::ForEach(Source.Data.begin(), Source.Data.end(), fn);
+		}
+
+		template <typename Func>
+		[[nodiscard]] decltype(auto) Map(Func &&fn) const
+		{
+			using R = decltype(fn(Source.Data.at(0)));
+			if constexpr (!std::is_default_constructible_v<R>)
+			{
+				return Source.Map(fn);
+			}
+			else
+			{
+				if (!UseParallel())
+					return Source.Map(fn);
+
+				auto buf = Source.template NewArray<R>();
+				if constexpr (std::is_same_v<R, bool>)
+				{
+					// vector<bool> can not be written concurrently
+					const auto mask = Mask(fn);
+					buf.Data.assign(mask.begin(), mask.end());
+				}
+				else
+				{
+					buf.Data.resize(Source.Length());
+					Parallel::Map(Source.Data.begin(), Source.Data.end(), buf.Data.begin(), fn);
+				}
+				return buf;
+			}
+		}
+
+		[[nodiscard]] decltype(auto) Max() const
+		{
+			if (!UseParallel())
+				return Source.Max();
+			return *Parallel::MaxElement(Source.Data.begin(), Source.Data.end(), std::less<>{});
+		}
+
+		// keys are extracted once with Parallel::Map
+		template <typename Func>
+		[[nodiscard]] decltype(auto) MaxBy(Func &&fn) const
+		{
+			if (!UseParallel())
+				return Source.MaxBy(fn);
+			const auto keys = Map(fn);
+			return Source.Data[Parallel::MaxElement(keys.Data.begin(), keys.Data.end(), std::less<>{}) - keys.Data.begin()];
+		}
+
+		[[nodiscard]] decltype(auto) Min() const
+		{
+			if (!UseParallel())
+				return Source.Min();
+			return *Parallel::MaxElement(Source.Data.begin(), Source.Data.end(), std::greater<>{});
+		}
+
+		// the comparison is reversed so MaxElement keeps the first of equal minima like std::min_element
+		template <typename Func>
+		[[nodiscard]] decltype(auto) MinBy(Func &&fn) const
+		{
+			if (!UseParallel())
+				return Source.MinBy(fn);
+			const auto keys = Map(fn);
+			return Source.Data[Parallel::MaxElement(keys.Data.begin(), keys.Data.end(), std::greater<>{}) - keys.Data.begin()];
+		}
+
+		[[nodiscard]] decltype(auto) Sort() const
+		{
+			return SortWith(std::less<>{});
+		}
+
+		// keys are extracted once with Parallel::Map and sorted with their index, so the result matches Array::SortBy
+		template <typename Func>
+		[[nodiscard]] decltype(auto) SortBy(Func &&fn) const
+		{
+			using K = std::decay_t<decltype(fn(Source.Data.at(0)))>;
+			using Keyed = std::pair<K, std::size_t>;
+			if constexpr (!std::is_default_constructible_v<K>)
+			{
+				return Source.SortBy(fn);
+			}
+			else
+			{
+				if (!UseParallel())
+					return Source.SortBy(fn);
+
+				std::vector<Keyed> keys(Source.Length());
+				Parallel::Map(Source.Data.begin(), Source.Data.end(), keys.begin(),
+							  [&, data = Source.Data.data()](const auto &x)
+							  { return Keyed(fn(x), static_cast<std::size_t>(&x - data)); });
+				Parallel::Sort(keys.begin(), keys.end(), __Detail::KeyIndexLess{});
+
+				auto buf = Source.NewArray();
+				buf.Data.reserve(keys.size());
+				for (const auto &k : keys)
+					buf.Data.push_back(Source.Data[k.second]);
+				return buf;
+			}
+		}
+
+		template <typename Func>
+		[[nodiscard]] decltype(auto) SortWith(Func &&fn) const
+		{
+			if (!UseParallel())
+				return Source.SortWith(fn);
+			auto buf = Source.NewArray();
+			buf.Data.assign(Source.Data.begin(), Source.Data.end());
+			Parallel::Sort(buf.Data.begin(), buf.Data.end(), fn);
+			return buf;
+		}
+
+		// floating point sums use ReduceMode::Deterministic so repeated calls agree bit for bit
+		[[nodiscard]] decltype(auto) Sum() const
+		{
+			if (!UseParallel())
+				return Source.Sum();
+			if constexpr (std::is_floating_point_v<ValueType>)
+				return Parallel::Reduce(Source.Data.begin(), Source.Data.end(), Parallel::ReduceMode::Deterministic);
+			else
+				return Parallel::Reduce(Source.Data.begin(), Source.Data.end());
+		}
+
+		template <typename Func>
+		[[nodiscard]] decltype(auto) SumBy(Func &&fn) const
+		{
+			const auto mapped = Map(fn);
+			return mapped.Par(Threshold).Sum();
+		}
+
+	private:
+		template <typename Func>
+		[[nodiscard]] std::vector<std::uint8_t> Mask(Func &&fn) const
+		{
+			std::vector<std::uint8_t> mask(Source.Length());
+			Parallel::Map(Source.Data.begin(), Source.Data.end(), mask.begin(),
+						  [&](const auto &x) -> std::uint8_t
+						  { return fn(x) ? 1 : 0; });
+			return mask;
+		}
+	};
+
+	template <typename T, typename Alloc>
+	[[nodiscard]] decltype(auto) Par(const Array<T, Alloc> &arr, const std::size_t threshold = DefaultParallelThreshold)
+	{
+		return ParArray<T, Alloc>(arr, threshold);
+	}
+} // namespace CuFunc
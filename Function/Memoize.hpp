@@ -0,0 +1,274 @@
+#pragma once
+
+#include "Function.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace CuFunc
+{
+	struct MemoizeStats
+	{
+		std::uint64_t Hits = 0;
+		std::uint64_t Misses = 0;
+		std::uint64_t Evictions = 0;
+		std::size_t Size = 0;
+
+		[[nodiscard]] double HitRate() const
+		{
+			const auto total = Hits + Misses;
+			return total == 0 ? 0. : static_cast<double>(Hits) / static_cast<double>(total);
+		}
+
+		MemoizeStats &operator+=(const MemoizeStats &other)
+		{
+			Hits += other.Hits;
+			Misses += other.Misses;
+			Evictions += other.Evictions;
+			Size += other.Size;
+			return *this;
+		}
+	};
+
+	namespace __Detail
+	{
+		// combines std::hash of every argument, boost::hash_combine style
+		struct TupleHash
+		{
+			template <typename... Args>
+			std::size_t operator()(const std::tuple<Args...> &args) const
+			{
+				std::size_t seed = 0;
+				std::apply([&](const auto &...x)
+						   { ((seed ^= std::hash<std::decay_t<decltype(x)>>{}(x) + 0x9e3779b9 + (seed << 6) + (seed >> 2)), ...); },
+						   args);
+				return seed;
+			}
+		};
+
+		// lambdas and functors through their operator(), functions and function pointers through their type
+		template <typename Fn, typename = void>
+		struct CallableHelper : FunctionHelper<std::remove_pointer_t<Fn>>
+		{
+		};
+
+		template <typename Fn>
+		struct CallableHelper<Fn, std::void_t<decltype(&Fn::operator())>> : FunctionHelper<decltype(&Fn::operator())>
+		{
+		};
+
+		// most recently used entry first, the index points into the list so lookups and evictions are O(1)
+		template <typename Key, typename Value>
+		class LruCache
+		{
+		public:
+			explicit LruCache(const std::size_t capacity) : capacity(capacity)
+			{
+			}
+
+			// index holds iterators into order, a copy would point them at the source's list.
+			// moving a list keeps its iterators valid, so moves are fine
+			LruCache(const LruCache &) = delete;
+			LruCache &operator=(const LruCache &) = delete;
+			LruCache(LruCache &&) = default;
+			LruCache &operator=(LruCache &&) = default;
+
+			const Value *Find(const Key &key)
+			{
+				const auto it = index.Find(key);
+				if (it == index.end())
+				{
+					++stats.Misses;
+					return nullptr;
+				}
+				++stats.Hits;
+				order.splice(order.begin(), order, it->second);
+				return &it->second->second;
+			}
+
+			void Put(Key key, Value value)
+			{
+				if (capacity == 0)
+					return;
+				if (const auto it = index.Find(key); it != index.end())
+				{
+					it->second->second = std::move(value);
+					order.splice(order.begin(), order, it->second);
+					return;
+				}
+				if (order.size() == capacity)
+				{
+					index.Erase(order.back().first);
+					order.pop_back();
+					++stats.Evictions;
+				}
+				order.emplace_front(std::move(key), std::move(value));
+				index.TryEmplace(order.front().first, order.begin());
+			}
+
+			void Clear()
+			{
+				index.Clear();
+				order.clear();
+				stats = {};
+			}
+
+			[[nodiscard]] MemoizeStats Stats() const
+			{
+				auto res = stats;
+				res.Size = order.size();
+				return res;
+			}
+
+		private:
+			using Entry = std::pair<Key, Value>;
+
+			std::size_t capacity;
+			std::list<Entry> order{};
+			CuContainer::FlatHashMap<Key, typename std::list<Entry>::iterator, TupleHash> index{};
+			MemoizeStats stats{};
+		};
+	} // namespace __Detail
+
+	template <typename Func, typename Result, typename ArgsTuple>
+	class Memoized;
+
+	// caches results by argument tuple and evicts the least recently used one past Capacity, not thread safe
+	template <typename Func, typename Result, typename... Args>
+	class Memoized<Func, Result, std::tuple<Args...>>
+	{
+	public:
+		using Key = std::tuple<std::decay_t<Args>...>;
+		using Value = std::decay_t<Result>;
+
+		Memoized(Func fn, const std::size_t capacity) : func(std::move(fn)), cache(capacity)
+		{
+		}
+
+		Value operator()(const std::decay_t<Args> &...args)
+		{
+			Key key(args...);
+			if (const auto *val = cache.Find(key))
+				return *val;
+			Value val = std::invoke(func, args...);
+			cache.Put(std::move(key), val);
+			return val;
+		}
+
+		void Clear()
+		{
+			cache.Clear();
+		}
+
+		[[nodiscard]] MemoizeStats Stats() const
+		{
+			return cache.Stats();
+		}
+
+	private:
+		Func func;
+		__Detail::LruCache<Key, Value> cache;
+	};
+
+	template <typename Func, typename Result, typename ArgsTuple>
+	class ConcurrentMemoized;
+
+	// keys are spread over independently locked LRU shards, each holding a share of the capacity.
+	// fn runs outside the lock, concurrent misses on one key may each call it and the last result is kept
+	template <typename Func, typename Result, typename... Args>
+	class ConcurrentMemoized<Func, Result, std::tuple<Args...>>
+	{
+	public:
+		using Key = std::tuple<std::decay_t<Args>...>;
+		using Value = std::decay_t<Result>;
+
+		ConcurrentMemoized(Func fn, const std::size_t capacity, const std::size_t shardCount) : func(std::move(fn))
+		{
+			// the first capacity % n shards take one extra slot, so the shares add up to capacity
+			const auto n = std::max<std::size_t>(shardCount, 1);
+			for (std::size_t i = 0; i < n; ++i)
+				shards.push_back(std::make_unique<Shard>(capacity / n + (i < capacity % n ? 1 : 0)));
+		}
+
+		Value operator()(const std::decay_t<Args> &...args)
+		{
+			Key key(args...);
+			auto &shard = ShardOf(key);
+			{
+				std::lock_guard lock(shard.Mtx);
+				if (const auto *val = shard.Cache.Find(key))
+					return *val;
+			}
+			Value val = std::invoke(func, args...);
+			{
+				std::lock_guard lock(shard.Mtx);
+				shard.Cache.Put(std::move(key), val);
+			}
+			return val;
+		}
+
+		void Clear()
+		{
+			for (auto &shard : shards)
+			{
+				std::lock_guard lock(shard->Mtx);
+				shard->Cache.Clear();
+			}
+		}
+
+		[[nodiscard]] MemoizeStats Stats() const
+		{
+			MemoizeStats res{};
+			for (const auto &shard : shards)
+			{
+				std::lock_guard lock(shard->Mtx);
+				res += shard->Cache.Stats();
+			}
+			return res;
+		}
+
+	private:
+		struct Shard
+		{
+			explicit Shard(const std::size_t capacity) : Cache(capacity)
+			{
+			}
+
+			mutable std::mutex Mtx{};
+			__Detail::LruCache<Key, Value> Cache;
+		};
+
+		Func func;
+		std::vector<std::unique_ptr<Shard>> shards{};
+
+		Shard &ShardOf(const Key &key)
+		{
+			// the high bits pick the shard, the table inside a shard probes with the mixed low bits
+			const auto h = static_cast<std::uint64_t>(__Detail::TupleHash{}(key)) * 0x9e3779b97f4a7c15ull;
+			return *shards[(h >> 32) % shards.size()];
+		}
+	};
+
+	// the argument types come from fn's signature, generic lambdas need an explicit parameter list
+	template <typename Func>
+	[[nodiscard]] decltype(auto) Memoize(Func fn, const std::size_t capacity)
+	{
+		using Helper = __Detail::CallableHelper<std::decay_t<Func>>;
+		return Memoized<Func, typename Helper::Result, typename Helper::Args>(std::move(fn), capacity);
+	}
+
+	template <typename Func>
+	[[nodiscard]] decltype(auto) ConcurrentMemoize(Func fn, const std::size_t capacity, const std::size_t shardCount = 16)
+	{
+		using Helper = __Detail::CallableHelper<std::decay_t<Func>>;
+		return ConcurrentMemoized<Func, typename Helper::Result, typename Helper::Args>(std::move(fn), capacity,
+																					   shardCount);
+	}
+} // namespace CuFunc
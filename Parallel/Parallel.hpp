@@ -1,9 +1,22 @@
 #pragma once
 
 #include "../Utility/Utility.hpp"
+#include "../Thread/Thread.hpp"
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <iterator>
+#include <mutex>
 #include <numeric>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 // ParallellUseTbb
 // ParallelUseOpenMP
@@ -447,21 +460,29 @@ namespace Parallel
         struct MaxElementBody
         {
             Iter res{};
+            bool found = false;
 
             Func func;
 
             MaxElementBody(Func func) : func(func) {}
             MaxElementBody(MaxElementBody &body, tbb::split) : func(body.func) {}
 
-            void operator()(tbb::blocked_range<Iter> &rng)
+            // a body may be handed several consecutive ranges
+            void operator()(const tbb::blocked_range<Iter> &rng)
             {
-                res = std::max_element(rng.begin(), rng.end(), func);
+                const auto cur = std::max_element(rng.begin(), rng.end(), func);
+                if (!found || func(*res, *cur))
+                    res = cur;
+                found = true;
             }
 
             void join(const MaxElementBody &val)
             {
-                if (func(*res, *val.res))
+                if (val.found && (!found || func(*res, *val.res)))
+                {
                     res = val.res;
+                    found = true;
+                }
             }
         };
 
@@ -689,6 +710,192 @@ namespace Parallel
 #endif
     }
 
+    namespace _Detail
+    {
+        struct StringSortItem
+        {
+            std::uint64_t Prefix;
+            std::string_view Str;
+            std::size_t Index;
+        };
+
+        constexpr std::size_t StringSortPrefixSize = sizeof(std::uint64_t);
+        constexpr std::size_t StringSortInsertionThreshold = 16;
+        constexpr std::size_t StringSortParallelThreshold = 1 << 15;
+
+        // packs the characters [depth, depth + 8) big-endian so that integer order equals lexicographic order
+        inline std::uint64_t LoadStringPrefix(const std::string_view str, const std::size_t depth)
+        {
+            std::uint64_t prefix = 0;
+            const auto n = std::min(StringSortPrefixSize, str.size() - depth);
+            for (std::size_t i = 0; i < n; ++i)
+                prefix |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(str[depth + i])) << (56 - 8 * i);
+            return prefix;
+        }
+
+        inline void LoadStringPrefixes(StringSortItem *beg, StringSortItem *end, const std::size_t depth)
+        {
+            for (; beg != end; ++beg)
+                beg->Prefix = LoadStringPrefix(beg->Str, depth);
+        }
+
+        // moves the strings that end inside the current prefix to the front, ordered by length,
+        // and returns the first item that still has characters past depth + 8
+        inline StringSortItem *SplitFinishedStrings(StringSortItem *beg, StringSortItem *end, const std::size_t depth)
+        {
+            const auto mid = std::partition(beg, end, [&](const StringSortItem &item)
+                                            { return item.Str.size() <= depth + StringSortPrefixSize; });
+            std::sort(beg, mid, [](const StringSortItem &l, const StringSortItem &r)
+                      { return l.Str.size() < r.Str.size(); });
+            return mid;
+        }
+
+        inline void InsertionSortStrings(StringSortItem *beg, StringSortItem *end, const std::size_t depth)
+        {
+            const auto less = [&](const StringSortItem &l, const StringSortItem &r)
+            {
+                if (l.Prefix != r.Prefix)
+                    return l.Prefix < r.Prefix;
+                return l.Str.substr(depth) < r.Str.substr(depth);
+            };
+
+            for (auto i = beg + 1; i < end; ++i)
+            {
+                auto item = *i;
+                auto j = i;
+                for (; j != beg && less(item, *(j - 1)); --j)
+                    *j = *(j - 1);
+                *j = item;
+            }
+        }
+
+        // multikey quicksort on the cached 8-byte prefix, every item has at least depth characters
+        inline void MultikeyQuicksort(StringSortItem *beg, StringSortItem *end, std::size_t depth)
+        {
+            while (end - beg > 1)
+            {
+                if (static_cast<std::size_t>(end - beg) <= StringSortInsertionThreshold)
+                {
+                    InsertionSortStrings(beg, end, depth);
+                    return;
+                }
+
+                const auto a = beg->Prefix;
+                const auto b = (beg + (end - beg) / 2)->Prefix;
+                const auto c = (end - 1)->Prefix;
+                const auto pivot = std::max(std::min(a, b), std::min(std::max(a, b), c));
+
+                auto lt = beg;
+                auto gt = end;
+                for (auto i = beg; i < gt;)
+                {
+                    if (i->Prefix < pivot)
+                        std::swap(*lt++, *i++);
+                    else if (i->Prefix > pivot)
+                        std::swap(*i, *--gt);
+                    else
+                        ++i;
+                }
+
+                MultikeyQuicksort(beg, lt, depth);
+                MultikeyQuicksort(gt, end, depth);
+
+                beg = SplitFinishedStrings(lt, gt, depth);
+                end = gt;
+                depth += StringSortPrefixSize;
+                LoadStringPrefixes(beg, end, depth);
+            }
+        }
+
+        template <typename Func>
+        void ForEachEqualPrefix(StringSortItem *beg, StringSortItem *end, Func func)
+        {
+            while (beg != end)
+            {
+                auto run = beg + 1;
+                while (run != end && run->Prefix == beg->Prefix)
+                    ++run;
+                if (run - beg > 1)
+                    func(beg, run);
+                beg = run;
+            }
+        }
+
+        inline void SortStringItems(StringSortItem *beg, StringSortItem *end, const std::size_t depth)
+        {
+            Parallel::Sort(beg, end, [](const StringSortItem &l, const StringSortItem &r)
+                           { return l.Prefix < r.Prefix; });
+
+            std::vector<std::pair<StringSortItem *, StringSortItem *>> runs{};
+            ForEachEqualPrefix(beg, end, [&](StringSortItem *rb, StringSortItem *re)
+                               {
+                                   rb = SplitFinishedStrings(rb, re, depth);
+                                   if (re - rb < 2)
+                                       return;
+
+                                   if (static_cast<std::size_t>(re - rb) >= StringSortParallelThreshold)
+                                   {
+                                       Parallel::ForEach(rb, re, [=](StringSortItem &item)
+                                                         { item.Prefix = LoadStringPrefix(item.Str, depth + StringSortPrefixSize); });
+                                       SortStringItems(rb, re, depth + StringSortPrefixSize);
+                                   }
+                                   else
+                                   {
+                                       runs.emplace_back(rb, re);
+                                   } });
+
+            if (runs.empty())
+                return;
+
+            Parallel::ForEach(runs.begin(), runs.end(), [=](const std::pair<StringSortItem *, StringSortItem *> &run)
+                              {
+                                  LoadStringPrefixes(run.first, run.second, depth + StringSortPrefixSize);
+                                  MultikeyQuicksort(run.first, run.second, depth + StringSortPrefixSize); });
+        }
+    } // namespace _Detail
+
+    // sorts a range of std::string / std::string_view lexicographically by bytes
+    template <typename Iter>
+    void SortStrings(Iter beg, Iter end)
+    {
+        using T = typename std::iterator_traits<Iter>::value_type;
+        static_assert(std::is_convertible_v<const T &, std::string_view>, "SortStrings requires a range of narrow strings");
+
+        const auto size = static_cast<std::size_t>(end - beg);
+        if (size <= 1)
+            return;
+
+        std::vector<_Detail::StringSortItem> items(size);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            items[i].Str = *(beg + i);
+            items[i].Index = i;
+        }
+        Parallel::ForEach(items.begin(), items.end(), [](_Detail::StringSortItem &item)
+                          { item.Prefix = _Detail::LoadStringPrefix(item.Str, 0); });
+
+        _Detail::SortStringItems(items.data(), items.data() + size, 0);
+
+        // applies the permutation in place one cycle at a time, Index is reset to mark placed items
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            if (items[i].Index == i)
+                continue;
+
+            T tmp = std::move(*(beg + i));
+            auto pos = i;
+            while (items[pos].Index != i)
+            {
+                const auto src = items[pos].Index;
+                *(beg + pos) = std::move(*(beg + src));
+                items[pos].Index = pos;
+                pos = src;
+            }
+            *(beg + pos) = std::move(tmp);
+            items[pos].Index = pos;
+        }
+    }
+
     template <typename Iter, typename Func>
     Iter Unique(Iter beg, Iter end, Func func)
     {
@@ -814,6 +1021,164 @@ namespace Parallel
 #endif
     }
 
+    namespace _Detail
+    {
+        constexpr std::size_t SearchMinBlockSize = 2048;
+        constexpr std::size_t SearchMaxBlockCount = 1 << 14;
+        constexpr std::size_t SearchCutoffCheckMask = 0xff;
+
+        inline std::size_t SearchBlockSize(const std::size_t size)
+        {
+            return std::max(SearchMinBlockSize, (size + SearchMaxBlockCount - 1) / SearchMaxBlockCount);
+        }
+
+        inline void AtomicMin(std::atomic<std::size_t> &val, const std::size_t v)
+        {
+            auto cur = val.load(std::memory_order_relaxed);
+            while (v < cur && !val.compare_exchange_weak(cur, v, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        // scans [first, last) and lowers cutoff to the first match, giving up once an earlier match is known
+        template <typename Iter, typename Func>
+        void FindIfBlock(Iter beg, const std::size_t first, const std::size_t last, std::atomic<std::size_t> &cutoff, Func &func)
+        {
+            for (auto i = first; i < last; ++i)
+            {
+                if ((i & SearchCutoffCheckMask) == 0 && i >= cutoff.load(std::memory_order_relaxed))
+                    return;
+                if (func(*(beg + i)))
+                {
+                    AtomicMin(cutoff, i);
+                    return;
+                }
+            }
+        }
+
+#ifdef __ParallelUseTbb
+        template <typename Iter, typename Func>
+        Iter FindIfTbb(Iter beg, Iter end, Func func)
+        {
+            const auto size = static_cast<std::size_t>(end - beg);
+            const auto blockSize = SearchBlockSize(size);
+            const auto blockCount = (size + blockSize - 1) / blockSize;
+
+            std::atomic<std::size_t> cutoff = size;
+            tbb::parallel_for(tbb::blocked_range<std::size_t>(0, blockCount, 1),
+                              [&](tbb::blocked_range<std::size_t> &rng)
+                              {
+                                  for (auto b = rng.begin(); b != rng.end(); ++b)
+                                  {
+                                      const auto first = b * blockSize;
+                                      if (first >= cutoff.load(std::memory_order_relaxed))
+                                          return;
+                                      FindIfBlock(beg, first, std::min(first + blockSize, size), cutoff, func);
+                                  }
+                              });
+
+            return beg + cutoff.load();
+        }
+#endif
+
+#ifdef __ParallelUseOpenMP
+        template <typename Iter, typename Func>
+        Iter FindIfOpenMP(Iter beg, Iter end, Func func)
+        {
+            const auto size = static_cast<std::size_t>(end - beg);
+            const auto blockSize = SearchBlockSize(size);
+            const auto blockCount = (size + blockSize - 1) / blockSize;
+
+            std::atomic<std::size_t> cutoff = size;
+
+#pragma omp parallel for schedule(dynamic)
+            for (std::size_t b = 0; b < blockCount; ++b)
+            {
+                const auto first = b * blockSize;
+                if (first < cutoff.load(std::memory_order_relaxed))
+                    FindIfBlock(beg, first, std::min(first + blockSize, size), cutoff, func);
+            }
+
+            return beg + cutoff.load();
+        }
+#endif
+
+#ifdef __ParallelUseStb
+        template <typename Iter, typename Func>
+        Iter FindIfStb(Iter beg, Iter end, Func func)
+        {
+            const auto size = static_cast<std::size_t>(end - beg);
+            if (size == 0)
+                return end;
+
+            const auto blockSize = SearchBlockSize(size);
+            const auto blockCount = (size + blockSize - 1) / blockSize;
+            const auto threadCount = std::min<std::size_t>(std::thread::hardware_concurrency(), blockCount);
+
+            std::atomic<std::size_t> cutoff = size;
+            std::atomic<std::size_t> next = 0;
+
+            // blocks are claimed in order, so once a claimed block starts past the cutoff every later one does too
+            std::vector<std::future<void>> futures{};
+            for (std::size_t i = 0; i < threadCount; ++i)
+            {
+                futures.emplace_back(std::async(std::launch::async,
+                                                [&, func]() mutable
+                                                {
+                                                    for (auto b = next++; b < blockCount; b = next++)
+                                                    {
+                                                        const auto first = b * blockSize;
+                                                        if (first >= cutoff.load(std::memory_order_relaxed))
+                                                            return;
+                                                        FindIfBlock(beg, first, std::min(first + blockSize, size), cutoff, func);
+                                                    }
+                                                }));
+            }
+
+            for (auto &f : futures)
+                f.get();
+
+            return beg + cutoff.load();
+        }
+#endif
+    } // namespace _Detail
+
+    // returns the first element satisfying func, as std::find_if does
+    template <typename Iter, typename Func>
+    Iter FindIf(Iter beg, Iter end, Func func)
+    {
+#ifdef __ParallelUseTbb
+        return _Detail::FindIfTbb(beg, end, func);
+#elif defined(__ParallelUseOpenMP)
+        return _Detail::FindIfOpenMP(beg, end, func);
+#elif defined(__ParallelUseStb)
+        return _Detail::FindIfStb(beg, end, func);
+#elif defined(__ParallelUseSingleThread)
+        return std::find_if(beg, end, func);
+#else
+        return std::find_if(std::execution::par, beg, end, func);
+#endif
+    }
+
+    template <typename Iter, typename Func>
+    bool AnyOf(Iter beg, Iter end, Func func)
+    {
+        return Parallel::FindIf(beg, end, func) != end;
+    }
+
+    template <typename Iter, typename Func>
+    bool AllOf(Iter beg, Iter end, Func func)
+    {
+        return Parallel::FindIf(beg, end, [=](const auto &v)
+                                { return !func(v); }) == end;
+    }
+
+    template <typename Iter, typename Func>
+    bool NoneOf(Iter beg, Iter end, Func func)
+    {
+        return Parallel::FindIf(beg, end, func) == end;
+    }
+
     namespace _Detail
     {
 #ifdef __ParallelUseTbb
@@ -827,7 +1192,7 @@ namespace Parallel
             ReduceBody() {}
             ReduceBody(ReduceBody &, tbb::split) {}
 
-            void operator()(tbb::blocked_range<Iter> &rng)
+            void operator()(const tbb::blocked_range<Iter> &rng)
             {
                 res = std::reduce(rng.begin(), rng.end(), res);
             }
@@ -910,6 +1275,131 @@ namespace Parallel
 #endif
     }
 
+    enum class ReduceMode
+    {
+        // backend dependent summation order
+        Fast,
+        // fixed blocks and a fixed combination tree, the result does not depend on the backend or thread count
+        Deterministic,
+        // Deterministic with Kahan-style compensated summation inside and across blocks
+        Compensated,
+    };
+
+    namespace _Detail
+    {
+        constexpr std::size_t ReduceBlockSize = 4096;
+        constexpr std::size_t ReduceLanes = 8;
+
+        template <typename T>
+        struct ReducePartial
+        {
+            T Sum{};
+            T Comp{};
+        };
+
+        // Knuth's TwoSum: the same error term as Neumaier's branch, without the comparison that blocks vectorization
+        template <typename T>
+        void CompensatedAdd(T &sum, T &comp, const T val)
+        {
+            const auto t = sum + val;
+            const auto z = t - sum;
+            comp += (sum - (t - z)) + (val - z);
+            sum = t;
+        }
+
+        template <typename T>
+        T PairwiseSum(const T *beg, const T *end)
+        {
+            const auto size = end - beg;
+            if (size == 0)
+                return T{};
+            if (size == 1)
+                return *beg;
+            const auto mid = beg + size / 2;
+            return PairwiseSum(beg, mid) + PairwiseSum(mid, end);
+        }
+
+        // every lane is an independent accumulator, so the loop vectorizes without reassociating any addition
+        template <typename T, typename Iter>
+        ReducePartial<T> DeterministicBlockSum(Iter first, const std::size_t size)
+        {
+            T lanes[ReduceLanes]{};
+            const auto body = size - size % ReduceLanes;
+            std::size_t i = 0;
+            for (; i < body; i += ReduceLanes)
+                for (std::size_t l = 0; l < ReduceLanes; ++l)
+                    lanes[l] += *(first + (i + l));
+            for (; i < size; ++i)
+                lanes[i - body] += *(first + i);
+            return {PairwiseSum(lanes, lanes + ReduceLanes), T{}};
+        }
+
+        template <typename T, typename Iter>
+        ReducePartial<T> CompensatedBlockSum(Iter first, const std::size_t size)
+        {
+            T sums[ReduceLanes]{};
+            T comps[ReduceLanes]{};
+            const auto body = size - size % ReduceLanes;
+            std::size_t i = 0;
+            for (; i < body; i += ReduceLanes)
+                for (std::size_t l = 0; l < ReduceLanes; ++l)
+                    CompensatedAdd(sums[l], comps[l], static_cast<T>(*(first + (i + l))));
+            for (; i < size; ++i)
+                CompensatedAdd(sums[i - body], comps[i - body], static_cast<T>(*(first + i)));
+
+            ReducePartial<T> res{};
+            for (std::size_t l = 0; l < ReduceLanes; ++l)
+            {
+                CompensatedAdd(res.Sum, res.Comp, sums[l]);
+                res.Comp += comps[l];
+            }
+            return res;
+        }
+    } // namespace _Detail
+
+    // Compensated relies on strict IEEE semantics and is defeated by -ffast-math or /fp:fast
+    template <typename Iter>
+    typename std::iterator_traits<Iter>::value_type Reduce(Iter beg, Iter end, const ReduceMode mode)
+    {
+        using T = typename std::iterator_traits<Iter>::value_type;
+        using Partial = _Detail::ReducePartial<T>;
+
+        if (mode == ReduceMode::Fast)
+            return Parallel::Reduce(beg, end);
+
+        const auto size = static_cast<std::size_t>(end - beg);
+        if (size == 0)
+            return T{};
+
+        const bool compensated = mode == ReduceMode::Compensated && std::is_floating_point_v<T>;
+        const auto blockCount = (size + _Detail::ReduceBlockSize - 1) / _Detail::ReduceBlockSize;
+        std::vector<Partial> partials(blockCount);
+        Parallel::ForEach(partials.begin(), partials.end(),
+                          [=, data = partials.data()](Partial &p)
+                          {
+                              const auto first = static_cast<std::size_t>(&p - data) * _Detail::ReduceBlockSize;
+                              const auto n = std::min(_Detail::ReduceBlockSize, size - first);
+                              p = compensated ? _Detail::CompensatedBlockSum<T>(beg + first, n)
+                                              : _Detail::DeterministicBlockSum<T>(beg + first, n);
+                          });
+
+        if (!compensated)
+        {
+            std::vector<T> sums(blockCount);
+            std::transform(partials.begin(), partials.end(), sums.begin(), [](const Partial &p)
+                           { return p.Sum; });
+            return _Detail::PairwiseSum(sums.data(), sums.data() + blockCount);
+        }
+
+        Partial res{};
+        for (const auto &p : partials)
+        {
+            _Detail::CompensatedAdd(res.Sum, res.Comp, p.Sum);
+            res.Comp += p.Comp;
+        }
+        return res.Sum + res.Comp;
+    }
+
     namespace _Detail
     {
 #ifdef __ParallelUseTbb
@@ -1000,6 +1490,189 @@ namespace Parallel
         std::reverse(beg, end);
 #else
         return std::reverse(std::execution::par_unseq, beg, end);
+#endif
+    }
+
+    struct StreamConfig
+    {
+        std::size_t BatchSize = 256;
+        // batches queued, running or waiting to be emitted at the same time, 0 picks twice the thread count
+        std::size_t MaxBatches = 0;
+        // 0 picks std::thread::hardware_concurrency()
+        std::size_t ThreadCount = 0;
+        // MapStream hands results to the sink in input order
+        bool Ordered = false;
+
+        [[nodiscard]] std::size_t GetThreadCount() const
+        {
+            return ThreadCount ? ThreadCount : std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+        }
+
+        [[nodiscard]] std::size_t GetMaxBatches() const
+        {
+            return MaxBatches ? MaxBatches : 2 * GetThreadCount();
+        }
+    };
+
+    namespace _Detail
+    {
+        // the calling thread pulls batches from the iterator, workers run onBatch(seq, batch, inflight) which must
+        // release inflight once the batch no longer occupies memory
+        template <typename T, typename Iter, typename Sentinel, typename OnBatch>
+        void StreamBatches(Iter beg, Sentinel end, const StreamConfig &config, OnBatch onBatch)
+        {
+            using Batch = std::pair<std::size_t, std::vector<T>>;
+
+            const auto threadCount = config.GetThreadCount();
+            const auto maxBatches = config.GetMaxBatches();
+            const auto batchSize = std::max<std::size_t>(config.BatchSize, 1);
+
+            CuThread::Channel<std::optional<Batch>> queue{};
+            CuThread::Semaphore inflight(maxBatches);
+            std::atomic<bool> failed = false;
+            std::exception_ptr error = nullptr;
+            std::mutex errorMtx{};
+
+            const auto fail = [&]()
+            {
+                {
+                    std::lock_guard lock(errorMtx);
+                    if (!error)
+                        error = std::current_exception();
+                }
+                // wake the producer even if finished batches are parked waiting for the failed one
+                if (!failed.exchange(true))
+                    for (std::size_t i = 0; i < maxBatches; ++i)
+                        inflight.Release();
+            };
+
+            std::vector<std::future<void>> workers{};
+            for (std::size_t i = 0; i < threadCount; ++i)
+            {
+                workers.emplace_back(std::async(std::launch::async,
+                                                [&]()
+                                                {
+                                                    while (true)
+                                                    {
+                                                        auto batch = queue.Read();
+                                                        if (!batch)
+                                                            return;
+                                                        if (failed.load(std::memory_order_relaxed))
+                                                            continue;
+                                                        try
+                                                        {
+                                                            onBatch(batch->first, batch->second, inflight);
+                                                        }
+                                                        catch (...)
+                                                        {
+                                                            fail();
+                                                        }
+                                                    }
+                                                }));
+            }
+
+            try
+            {
+                for (std::size_t seq = 0; beg != end && !failed.load(std::memory_order_relaxed); ++seq)
+                {
+                    // the permit covers the batch from its first item, so at most maxBatches are ever resident
+                    inflight.WaitOne();
+                    if (failed.load(std::memory_order_relaxed))
+                        break;
+
+                    std::vector<T> items{};
+                    items.reserve(batchSize);
+                    for (; beg != end && items.size() < batchSize; ++beg)
+                        items.push_back(*beg);
+
+                    queue.Write(std::optional<Batch>(std::in_place, seq, std::move(items)));
+                }
+            }
+            catch (...)
+            {
+                fail();
+            }
+
+            for (std::size_t i = 0; i < threadCount; ++i)
+                queue.Write(std::nullopt);
+            for (auto &f : workers)
+                f.get();
+
+            if (error)
+                std::rethrow_exception(error);
+        }
+    } // namespace _Detail
+
+    // for forward and input iterators (directory iterators, lists, generators), items are copied into batches
+    template <typename Iter, typename Sentinel, typename Func>
+    void ForEachStream(Iter beg, Sentinel end, Func func, [[maybe_unused]] const StreamConfig &config = {})
+    {
+        using T = std::decay_t<decltype(*beg)>;
+
+#ifdef __ParallelUseSingleThread
+        for (; beg != end; ++beg)
+        {
+            T val = *beg;
+            func(val);
+        }
+#else
+        _Detail::StreamBatches<T>(beg, end, config,
+                                  [&](std::size_t, std::vector<T> &batch, CuThread::Semaphore &inflight)
+                                  {
+                                      std::for_each(batch.begin(), batch.end(), func);
+                                      inflight.Release();
+                                  });
+#endif
+    }
+
+    // sink is never called concurrently; with config.Ordered it receives the results in input order
+    template <typename Iter, typename Sentinel, typename Func, typename Sink>
+    void MapStream(Iter beg, Sentinel end, Func func, Sink sink, [[maybe_unused]] const StreamConfig &config = {})
+    {
+        using T = std::decay_t<decltype(*beg)>;
+
+#ifdef __ParallelUseSingleThread
+        for (; beg != end; ++beg)
+        {
+            T val = *beg;
+            sink(func(val));
+        }
+#else
+        using R = std::decay_t<std::invoke_result_t<Func &, T &>>;
+
+        const auto maxBatches = config.GetMaxBatches();
+        std::vector<std::optional<std::vector<R>>> parked(maxBatches);
+        std::size_t nextEmit = 0;
+        std::mutex emitMtx{};
+
+        _Detail::StreamBatches<T>(beg, end, config,
+                                  [&](const std::size_t seq, std::vector<T> &batch, CuThread::Semaphore &inflight)
+                                  {
+                                      std::vector<R> results{};
+                                      results.reserve(batch.size());
+                                      std::transform(batch.begin(), batch.end(), std::back_inserter(results), func);
+                                      batch = {};
+
+                                      std::lock_guard lock(emitMtx);
+                                      if (!config.Ordered)
+                                      {
+                                          for (auto &r : results)
+                                              sink(std::move(r));
+                                          inflight.Release();
+                                          return;
+                                      }
+
+                                      // at most maxBatches are in flight, so seq never collides with an unemitted slot
+                                      parked[seq % maxBatches] = std::move(results);
+                                      for (auto *slot = &parked[nextEmit % maxBatches]; slot->has_value(); slot = &parked[nextEmit % maxBatches])
+                                      {
+                                          for (auto &r : **slot)
+                                              sink(std::move(r));
+                                          slot->reset();
+                                          ++nextEmit;
+                                          inflight.Release();
+                                      }
+                                  });
 #endif
     }
 } // namespace Parallel
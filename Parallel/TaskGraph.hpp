@@ -0,0 +1,412 @@
+#pragma once
+
+#include "Parallel.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Parallel
+{
+    class TaskGraphException : public std::runtime_error
+    {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    // tasks go to the submitting worker's deque; idle workers take from their own back and steal from the others' front
+    class WorkStealingPool
+    {
+    public:
+        using Task = std::function<void()>;
+
+        static constexpr std::size_t NotWorker = ~std::size_t{0};
+
+        explicit WorkStealingPool(const std::size_t threadCount = std::thread::hardware_concurrency())
+        {
+            const auto n = std::max<std::size_t>(threadCount, 1);
+            for (std::size_t i = 0; i < n; ++i)
+                workers.emplace_back(std::make_unique<Worker>());
+            for (std::size_t i = 0; i < n; ++i)
+                threads.emplace_back([this, i]()
+                                     { Run(i); });
+        }
+
+        WorkStealingPool(const WorkStealingPool &) = delete;
+        WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+        ~WorkStealingPool()
+        {
+            {
+                std::lock_guard lock(sleepMtx);
+                stop = true;
+            }
+            sleepCond.notify_all();
+            for (auto &t : threads)
+                t.join();
+        }
+
+        // tasks must not throw
+        void Submit(Task task)
+        {
+            const auto self = CurrentWorker();
+            const auto idx = self != NotWorker ? self : next.fetch_add(1, std::memory_order_relaxed) % workers.size();
+            {
+                std::lock_guard lock(workers[idx]->Mtx);
+                workers[idx]->Tasks.push_back(std::move(task));
+            }
+            pending.fetch_add(1, std::memory_order_release);
+            {
+                std::lock_guard lock(sleepMtx);
+            }
+            sleepCond.notify_one();
+        }
+
+        [[nodiscard]] std::size_t ThreadCount() const
+        {
+            return threads.size();
+        }
+
+        // index of the calling worker of this pool, NotWorker for any other thread
+        [[nodiscard]] std::size_t CurrentWorker() const
+        {
+            return currentPool == this ? currentIndex : NotWorker;
+        }
+
+    private:
+        struct Worker
+        {
+            std::mutex Mtx{};
+            std::deque<Task> Tasks{};
+        };
+
+        std::vector<std::unique_ptr<Worker>> workers{};
+        std::vector<std::thread> threads{};
+
+        std::atomic<std::size_t> pending = 0;
+        std::atomic<std::size_t> next = 0;
+        std::mutex sleepMtx{};
+        std::condition_variable sleepCond{};
+        bool stop = false;
+
+        inline static thread_local const WorkStealingPool *currentPool = nullptr;
+        inline static thread_local std::size_t currentIndex = NotWorker;
+
+        bool TryPop(const std::size_t self, Task &task)
+        {
+            {
+                auto &own = *workers[self];
+                std::lock_guard lock(own.Mtx);
+                if (!own.Tasks.empty())
+                {
+                    task = std::move(own.Tasks.back());
+                    own.Tasks.pop_back();
+                    return true;
+                }
+            }
+
+            for (std::size_t i = 1; i < workers.size(); ++i)
+            {
+                auto &victim = *workers[(self + i) % workers.size()];
+                std::lock_guard lock(victim.Mtx);
+                if (!victim.Tasks.empty())
+                {
+                    task = std::move(victim.Tasks.front());
+                    victim.Tasks.pop_front();
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        void Run(const std::size_t index)
+        {
+            currentPool = this;
+            currentIndex = index;
+
+            while (true)
+            {
+                Task task{};
+                if (TryPop(index, task))
+                {
+                    pending.fetch_sub(1, std::memory_order_acq_rel);
+                    task();
+                    continue;
+                }
+
+                std::unique_lock lock(sleepMtx);
+                sleepCond.wait(lock, [&]()
+                               { return stop || pending.load(std::memory_order_acquire) != 0; });
+                if (stop && pending.load(std::memory_order_acquire) == 0)
+                    return;
+            }
+        }
+    };
+
+    inline WorkStealingPool &DefaultPool()
+    {
+        static WorkStealingPool pool{};
+        return pool;
+    }
+
+    // nodes start as soon as all their predecessors finished; the topology is validated once and reused by later runs
+    class TaskGraph
+    {
+    public:
+        using NodeId = std::size_t;
+        using Clock = std::chrono::steady_clock;
+
+        struct TraceEvent
+        {
+            NodeId Node;
+            const std::string &Name;
+            std::size_t Worker;
+            Clock::time_point Begin;
+            Clock::time_point End;
+        };
+
+        // called on the worker right after a node finished
+        std::function<void(const TraceEvent &)> TraceHandler = nullptr;
+
+        TaskGraph() = default;
+        explicit TaskGraph(WorkStealingPool &pool) : pool(&pool) {}
+
+        TaskGraph(const TaskGraph &) = delete;
+        TaskGraph &operator=(const TaskGraph &) = delete;
+
+        NodeId Emplace(std::function<void()> func, const std::vector<NodeId> &deps = {}, std::string name = {})
+        {
+            const auto id = nodes.size();
+            nodes.push_back(Node{std::move(func), std::move(name)});
+            for (const auto dep : deps)
+                Precede(dep, id);
+            dirty = true;
+            return id;
+        }
+
+        void Precede(const NodeId before, const NodeId after)
+        {
+            if (before >= nodes.size() || after >= nodes.size())
+                throw TaskGraphException("node id out of range");
+            nodes[before].Successors.push_back(after);
+            ++nodes[after].Predecessors;
+            dirty = true;
+        }
+
+        [[nodiscard]] std::size_t Size() const
+        {
+            return nodes.size();
+        }
+
+        void Clear()
+        {
+            nodes.clear();
+            dirty = true;
+        }
+
+        // rethrows the first exception thrown by a node, nodes depending on a failed run are skipped
+        void Run()
+        {
+            if (nodes.empty())
+                return;
+
+            Prepare();
+
+#ifdef __ParallelUseSingleThread
+            for (const auto id : order)
+            {
+                if (!failed.load(std::memory_order_relaxed))
+                    Invoke(id);
+            }
+#else
+            if (!pool)
+                pool = &DefaultPool();
+
+            for (std::size_t i = 0; i < nodes.size(); ++i)
+                remaining[i].store(nodes[i].Predecessors, std::memory_order_relaxed);
+
+            const auto state = std::make_shared<RunState>();
+            for (const auto id : roots)
+                pool->Submit([this, id, state]()
+                             { Execute(id, state); });
+
+            std::unique_lock lock(state->DoneMtx);
+            state->DoneCond.wait(lock, [&]()
+                                 { return state->Finished; });
+#endif
+
+            failed.store(false, std::memory_order_relaxed);
+            if (error)
+                std::rethrow_exception(std::exchange(error, nullptr));
+        }
+
+        // the longest chain of the previous run, weighted by the measured node durations
+        [[nodiscard]] std::vector<NodeId> CriticalPath() const
+        {
+            if (order.size() != nodes.size() || nodes.empty())
+                return {};
+
+            std::vector<Clock::duration> cost(nodes.size(), Clock::duration::zero());
+            std::vector<NodeId> prev(nodes.size(), nodes.size());
+            for (const auto id : order)
+            {
+                cost[id] += nodes[id].LastDuration;
+                for (const auto succ : nodes[id].Successors)
+                {
+                    if (cost[id] > cost[succ] || prev[succ] == nodes.size())
+                    {
+                        cost[succ] = cost[id];
+                        prev[succ] = id;
+                    }
+                }
+            }
+
+            auto last = std::max_element(cost.begin(), cost.end()) - cost.begin();
+            std::vector<NodeId> path{};
+            for (auto id = static_cast<NodeId>(last); id != nodes.size(); id = prev[id])
+                path.push_back(id);
+            std::reverse(path.begin(), path.end());
+            return path;
+        }
+
+        [[nodiscard]] Clock::duration LastDuration(const NodeId id) const
+        {
+            return nodes.at(id).LastDuration;
+        }
+
+    private:
+        struct Node
+        {
+            std::function<void()> Func;
+            std::string Name;
+            std::vector<NodeId> Successors{};
+            std::size_t Predecessors = 0;
+            Clock::duration LastDuration = Clock::duration::zero();
+        };
+
+        WorkStealingPool *pool = nullptr;
+        std::vector<Node> nodes{};
+        std::vector<NodeId> roots{};
+        std::vector<NodeId> order{};
+        std::unique_ptr<std::atomic<std::size_t>[]> remaining{};
+        bool dirty = true;
+
+        std::atomic<bool> failed = false;
+        std::exception_ptr error = nullptr;
+        std::mutex errorMtx{};
+
+        // Run may return and the graph be destroyed as soon as the last node is counted, so the completion
+        // state is shared with the tasks of the run instead of living in the graph
+        struct RunState
+        {
+            std::atomic<std::size_t> Completed = 0;
+            std::mutex DoneMtx{};
+            std::condition_variable DoneCond{};
+            bool Finished = false;
+        };
+
+        void Prepare()
+        {
+            if (!dirty)
+                return;
+
+            roots.clear();
+            order.clear();
+            std::vector<std::size_t> indegree(nodes.size());
+            for (std::size_t i = 0; i < nodes.size(); ++i)
+            {
+                indegree[i] = nodes[i].Predecessors;
+                if (indegree[i] == 0)
+                    roots.push_back(i);
+            }
+
+            order = roots;
+            for (std::size_t i = 0; i < order.size(); ++i)
+            {
+                for (const auto succ : nodes[order[i]].Successors)
+                {
+                    if (--indegree[succ] == 0)
+                        order.push_back(succ);
+                }
+            }
+
+            if (order.size() != nodes.size())
+            {
+                order.clear();
+                throw TaskGraphException("task graph contains a cycle");
+            }
+
+            remaining = std::make_unique<std::atomic<std::size_t>[]>(nodes.size());
+            dirty = false;
+        }
+
+        void Invoke(const NodeId id)
+        {
+            auto &node = nodes[id];
+            const auto begin = Clock::now();
+            try
+            {
+                if (node.Func)
+                    node.Func();
+            }
+            catch (...)
+            {
+                std::lock_guard lock(errorMtx);
+                if (!error)
+                    error = std::current_exception();
+                failed.store(true, std::memory_order_relaxed);
+            }
+            const auto end = Clock::now();
+            node.LastDuration = end - begin;
+
+            if (TraceHandler)
+                TraceHandler(TraceEvent{id, node.Name, pool ? pool->CurrentWorker() : WorkStealingPool::NotWorker, begin, end});
+        }
+
+        void Execute(NodeId id, const std::shared_ptr<RunState> &state)
+        {
+            const auto count = nodes.size();
+            while (true)
+            {
+                if (!failed.load(std::memory_order_relaxed))
+                    Invoke(id);
+
+                // the first ready successor runs on this worker, the others become stealable
+                auto next = count;
+                for (const auto succ : nodes[id].Successors)
+                {
+                    if (remaining[succ].fetch_sub(1, std::memory_order_acq_rel) != 1)
+                        continue;
+                    if (next == count)
+                        next = succ;
+                    else
+                        pool->Submit([this, succ, state]()
+                                     { Execute(succ, state); });
+                }
+
+                // past this point the graph may be gone unless next is set, only locals and state are used
+                if (state->Completed.fetch_add(1, std::memory_order_acq_rel) + 1 == count)
+                {
+                    std::lock_guard lock(state->DoneMtx);
+                    state->Finished = true;
+                    state->DoneCond.notify_all();
+                    return;
+                }
+
+                if (next == count)
+                    return;
+                id = next;
+            }
+        }
+    };
+}
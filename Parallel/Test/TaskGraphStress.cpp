@@ -0,0 +1,64 @@
+// destroys each graph right after Run returns, a worker still touching the graph shows up under
+// -fsanitize=thread or -fsanitize=address
+// g++ -std=c++20 -O1 -g -fsanitize=thread Parallel/Test/TaskGraphStress.cpp -o TaskGraphStress -pthread
+
+#include <string>
+#include <tuple>
+
+#include "../TaskGraph.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    bool Independent(Parallel::WorkStealingPool &pool, const int iterations, const int width)
+    {
+        std::atomic<int> ran = 0;
+        for (int i = 0; i < iterations; ++i)
+        {
+            auto graph = std::make_unique<Parallel::TaskGraph>(pool);
+            for (int j = 0; j < width; ++j)
+                graph->Emplace([&]()
+                               { ran.fetch_add(1, std::memory_order_relaxed); });
+            graph->Run();
+        }
+        return ran.load() == iterations * width;
+    }
+
+    // a root, width nodes after it and a sink after those, so the run ends on a stolen successor
+    bool Diamond(Parallel::WorkStealingPool &pool, const int iterations, const int width)
+    {
+        std::atomic<int> ran = 0;
+        for (int i = 0; i < iterations; ++i)
+        {
+            auto graph = std::make_unique<Parallel::TaskGraph>(pool);
+            const auto count = [&]()
+            { ran.fetch_add(1, std::memory_order_relaxed); };
+            const auto root = graph->Emplace(count);
+            std::vector<Parallel::TaskGraph::NodeId> mid{};
+            for (int j = 0; j < width; ++j)
+                mid.push_back(graph->Emplace(count, {root}));
+            graph->Emplace(count, mid);
+            graph->Run();
+        }
+        return ran.load() == iterations * (width + 2);
+    }
+}
+
+int main()
+{
+    Parallel::WorkStealingPool pool(4);
+
+    bool ok = true;
+    const auto check = [&](const char *name, const bool passed)
+    {
+        std::printf("%-12s %s\n", name, passed ? "ok" : "FAILED");
+        ok &= passed;
+    };
+    check("independent", Independent(pool, 20000, 8));
+    check("diamond", Diamond(pool, 20000, 8));
+    return ok ? 0 : 1;
+}
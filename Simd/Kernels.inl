@@ -0,0 +1,190 @@
+// the kernels of one isa, Simd.hpp includes this once per isa with __CuSimd_KernelNs__ naming the namespace and
+// __CuSimd_Kernel__ the target attribute. Every function handling a register is compiled for the isa of the register,
+// so none crosses into code built for a lower one however the compiler inlines
+
+namespace CuSimd::Detail::__CuSimd_KernelNs__
+{
+	// four independent accumulators hide the add latency, floating point sums are summed lane wise
+	struct SumKernel
+	{
+		template <typename V, typename T>
+		__CuSimd_Kernel__ static T Run(const T *p, const std::size_t n)
+		{
+			constexpr auto l = V::Lanes;
+			auto a0 = V::Set1(T{}), a1 = a0, a2 = a0, a3 = a0;
+			std::size_t i = 0;
+			for (; i + 4 * l <= n; i += 4 * l)
+			{
+				a0 = V::Add(a0, V::Load(p + i));
+				a1 = V::Add(a1, V::Load(p + i + l));
+				a2 = V::Add(a2, V::Load(p + i + 2 * l));
+				a3 = V::Add(a3, V::Load(p + i + 3 * l));
+			}
+			for (; i + l <= n; i += l)
+				a0 = V::Add(a0, V::Load(p + i));
+
+			T lanes[l];
+			V::Store(lanes, V::Add(V::Add(a0, a1), V::Add(a2, a3)));
+			auto res = lanes[0];
+			for (std::size_t j = 1; j < l; ++j)
+				res += lanes[j];
+			for (; i < n; ++i)
+				res += p[i];
+			return res;
+		}
+	};
+
+	struct DotKernel
+	{
+		template <typename V, typename T>
+		__CuSimd_Kernel__ static T Run(const T *a, const T *b, const std::size_t n)
+		{
+			constexpr auto l = V::Lanes;
+			auto a0 = V::Set1(T{}), a1 = a0;
+			std::size_t i = 0;
+			for (; i + 2 * l <= n; i += 2 * l)
+			{
+				a0 = V::Add(a0, V::Mul(V::Load(a + i), V::Load(b + i)));
+				a1 = V::Add(a1, V::Mul(V::Load(a + i + l), V::Load(b + i + l)));
+			}
+			for (; i + l <= n; i += l)
+				a0 = V::Add(a0, V::Mul(V::Load(a + i), V::Load(b + i)));
+
+			T lanes[l];
+			V::Store(lanes, V::Add(a0, a1));
+			auto res = lanes[0];
+			for (std::size_t j = 1; j < l; ++j)
+				res += lanes[j];
+			for (; i < n; ++i)
+				res += a[i] * b[i];
+			return res;
+		}
+	};
+
+	// lanes start from p[0], so like std::min_element a leading NaN is returned and later NaNs are skipped
+	template <bool IsMax>
+	struct ExtremeKernel
+	{
+		template <typename T>
+		__CuSimd_Kernel__ static T Pick(const T x, const T m)
+		{
+			if constexpr (IsMax)
+				return x > m ? x : m;
+			else
+				return x < m ? x : m;
+		}
+
+		template <typename V, typename T>
+		__CuSimd_Kernel__ static T Run(const T *p, const std::size_t n)
+		{
+			constexpr auto l = V::Lanes;
+			auto m0 = V::Set1(p[0]), m1 = m0;
+			std::size_t i = 0;
+			for (; i + 2 * l <= n; i += 2 * l)
+			{
+				if constexpr (IsMax)
+				{
+					m0 = V::Max(V::Load(p + i), m0);
+					m1 = V::Max(V::Load(p + i + l), m1);
+				}
+				else
+				{
+					m0 = V::Min(V::Load(p + i), m0);
+					m1 = V::Min(V::Load(p + i + l), m1);
+				}
+			}
+			for (; i + l <= n; i += l)
+			{
+				if constexpr (IsMax)
+					m0 = V::Max(V::Load(p + i), m0);
+				else
+					m0 = V::Min(V::Load(p + i), m0);
+			}
+
+			T lanes0[l], lanes1[l];
+			V::Store(lanes0, m0);
+			V::Store(lanes1, m1);
+			auto res = p[0];
+			for (std::size_t j = 0; j < l; ++j)
+				res = Pick(lanes1[j], Pick(lanes0[j], res));
+			for (; i < n; ++i)
+				res = Pick(p[i], res);
+			return res;
+		}
+	};
+
+	// first index holding val, n when there is none
+	struct FindKernel
+	{
+		template <typename V, typename T>
+		__CuSimd_Kernel__ static std::size_t Run(const T *p, const std::size_t n, const T val)
+		{
+			constexpr auto l = V::Lanes;
+			const auto v = V::Set1(val);
+			std::size_t i = 0;
+			for (; i + l <= n; i += l)
+			{
+				if (const auto mask = V::EqMask(V::Load(p + i), v); mask != 0)
+					return i + static_cast<std::size_t>(std::countr_zero(mask));
+			}
+			for (; i < n; ++i)
+				if (p[i] == val)
+					return i;
+			return n;
+		}
+	};
+
+	// rhs is either a second array or a scalar broadcast to every lane
+	template <typename Op>
+	struct TransformKernel
+	{
+		template <typename V, typename T, typename Rhs>
+		__CuSimd_Kernel__ static void Run(const T *a, const Rhs b, T *out, const std::size_t n)
+		{
+			constexpr auto l = V::Lanes;
+			constexpr auto broadcast = !std::is_pointer_v<Rhs>;
+			const auto rhs = [&](const std::size_t i)
+			{
+				if constexpr (broadcast)
+					return b;
+				else
+					return b[i];
+			};
+
+			typename V::Reg y{};
+			if constexpr (broadcast)
+				y = V::Set1(b);
+			std::size_t i = 0;
+			for (; i + l <= n; i += l)
+			{
+				const auto x = V::Load(a + i);
+				if constexpr (!broadcast)
+					y = V::Load(b + i);
+				if constexpr (std::is_same_v<Op, std::plus<>> || std::is_same_v<Op, std::plus<T>>)
+					V::Store(out + i, V::Add(x, y));
+				else if constexpr (std::is_same_v<Op, std::minus<>> || std::is_same_v<Op, std::minus<T>>)
+					V::Store(out + i, V::Sub(x, y));
+				else if constexpr (std::is_same_v<Op, std::multiplies<>> || std::is_same_v<Op, std::multiplies<T>>)
+					V::Store(out + i, V::Mul(x, y));
+				else
+					V::Store(out + i, V::Div(x, y));
+			}
+			for (; i < n; ++i)
+				out[i] = Op{}(a[i], rhs(i));
+		}
+	};
+
+	struct Kernels
+	{
+		using Sum = SumKernel;
+		using Dot = DotKernel;
+		using Min = ExtremeKernel<false>;
+		using Max = ExtremeKernel<true>;
+		using Find = FindKernel;
+		template <typename Op>
+		using Transform = TransformKernel<Op>;
+	};
+} // namespace CuSimd::Detail::__CuSimd_KernelNs__
+
+#undef __CuSimd_KernelNs__
+#undef __CuSimd_Kernel__
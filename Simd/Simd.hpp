@@ -0,0 +1,522 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define __CuSimd_X86__
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+#ifdef __CuSimd_X86__
+#define __CuSimd_Dispatch__
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define __CuSimd_Target__(isa)
+#else
+#define __CuSimd_Target__(isa) __attribute__((target(isa)))
+#endif
+
+namespace CuSimd
+{
+	enum class Isa
+	{
+		Portable,
+		Sse2,
+		Avx2,
+		Avx512
+	};
+
+	inline Isa DetectIsa()
+	{
+#if defined(__CuSimd_Dispatch__) && defined(_MSC_VER) && !defined(__clang__)
+		int info[4]{};
+		__cpuid(info, 0);
+		const auto maxLeaf = info[0];
+		__cpuid(info, 1);
+		const bool sse2 = (info[3] & (1 << 26)) != 0;
+		const bool osxsave = (info[2] & (1 << 27)) != 0;
+		const auto xcr0 = osxsave ? _xgetbv(0) : 0;
+		if (maxLeaf >= 7 && (xcr0 & 0x6) == 0x6)
+		{
+			__cpuidex(info, 7, 0);
+			if ((info[1] & (1 << 16)) != 0 && (xcr0 & 0xe6) == 0xe6)
+				return Isa::Avx512;
+			if ((info[1] & (1 << 5)) != 0)
+				return Isa::Avx2;
+		}
+		return sse2 ? Isa::Sse2 : Isa::Portable;
+#elif defined(__CuSimd_Dispatch__)
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512f"))
+			return Isa::Avx512;
+		if (__builtin_cpu_supports("avx2"))
+			return Isa::Avx2;
+		if (__builtin_cpu_supports("sse2"))
+			return Isa::Sse2;
+		return Isa::Portable;
+#else
+		return Isa::Portable;
+#endif
+	}
+
+	namespace Detail
+	{
+		inline std::atomic<int> CurrentIsa{-1};
+	}
+
+	inline Isa GetIsa()
+	{
+		auto isa = Detail::CurrentIsa.load(std::memory_order_relaxed);
+		if (isa < 0)
+		{
+			isa = static_cast<int>(DetectIsa());
+			Detail::CurrentIsa.store(isa, std::memory_order_relaxed);
+		}
+		return static_cast<Isa>(isa);
+	}
+
+	// caps the dispatch level, requests above what the cpu supports are clamped
+	inline void SetIsa(const Isa isa)
+	{
+		Detail::CurrentIsa.store(static_cast<int>(std::min(isa, DetectIsa())), std::memory_order_relaxed);
+	}
+
+	template <typename T>
+	constexpr bool IsSupported = std::is_same_v<T, float> || std::is_same_v<T, double> || std::is_same_v<T, std::int32_t>;
+
+	// std functors Transform runs in vector registers, integer division stays scalar
+	template <typename Op, typename T>
+	constexpr bool IsVectorOp =
+		IsSupported<T> &&
+		(std::is_same_v<Op, std::plus<>> || std::is_same_v<Op, std::plus<T>> ||
+		 std::is_same_v<Op, std::minus<>> || std::is_same_v<Op, std::minus<T>> ||
+		 std::is_same_v<Op, std::multiplies<>> || std::is_same_v<Op, std::multiplies<T>> ||
+		 (std::is_floating_point_v<T> && (std::is_same_v<Op, std::divides<>> || std::is_same_v<Op, std::divides<T>>)));
+
+	namespace Detail
+	{
+		template <Isa I, typename T>
+		struct Vec;
+
+		// plain lane arrays, left to the auto vectorizer of the target
+		template <typename T>
+		struct Vec<Isa::Portable, T>
+		{
+			static constexpr std::size_t Lanes = 4;
+
+			struct Reg
+			{
+				T V[Lanes];
+			};
+
+			template <typename F>
+			static Reg Apply(const Reg &a, const Reg &b, F f)
+			{
+				Reg r;
+				for (std::size_t i = 0; i < Lanes; ++i)
+					r.V[i] = f(a.V[i], b.V[i]);
+				return r;
+			}
+
+			static Reg Load(const T *p)
+			{
+				Reg r;
+				std::copy_n(p, Lanes, r.V);
+				return r;
+			}
+
+			static void Store(T *p, const Reg &a)
+			{
+				std::copy_n(a.V, Lanes, p);
+			}
+
+			static Reg Set1(const T v)
+			{
+				Reg r;
+				std::fill_n(r.V, Lanes, v);
+				return r;
+			}
+
+			static Reg Add(const Reg &a, const Reg &b)
+			{
+				return Apply(a, b, std::plus<>{});
+			}
+
+			static Reg Sub(const Reg &a, const Reg &b)
+			{
+				return Apply(a, b, std::minus<>{});
+			}
+
+			static Reg Mul(const Reg &a, const Reg &b)
+			{
+				return Apply(a, b, std::multiplies<>{});
+			}
+
+			static Reg Div(const Reg &a, const Reg &b)
+			{
+				return Apply(a, b, std::divides<>{});
+			}
+
+			static Reg Min(const Reg &x, const Reg &m)
+			{
+				return Apply(x, m, [](const T a, const T b)
+							 { return a < b ? a : b; });
+			}
+
+			static Reg Max(const Reg &x, const Reg &m)
+			{
+				return Apply(x, m, [](const T a, const T b)
+							 { return a > b ? a : b; });
+			}
+
+			static std::uint64_t EqMask(const Reg &a, const Reg &b)
+			{
+				std::uint64_t mask = 0;
+				for (std::size_t i = 0; i < Lanes; ++i)
+					mask |= static_cast<std::uint64_t>(a.V[i] == b.V[i]) << i;
+				return mask;
+			}
+		};
+
+#ifdef __CuSimd_X86__
+		// Min(x, m) is x < m ? x : m and Max(x, m) is x > m ? x : m per lane, the same as the min/max instructions,
+		// so a NaN in x never replaces m
+#define __CuSimd_FloatVec__(isa, target, T, R, lanes, pre, suf, minOp, maxOp, eqMask)                        \
+	template <>                                                                                              \
+	struct Vec<Isa::isa, T>                                                                                  \
+	{                                                                                                        \
+		using Reg = R;                                                                                       \
+		static constexpr std::size_t Lanes = lanes;                                                          \
+		__CuSimd_Target__(target) static Reg Load(const T *p) { return pre##_loadu_##suf(p); }               \
+		__CuSimd_Target__(target) static void Store(T *p, const Reg a) { pre##_storeu_##suf(p, a); }         \
+		__CuSimd_Target__(target) static Reg Set1(const T v) { return pre##_set1_##suf(v); }                 \
+		__CuSimd_Target__(target) static Reg Add(const Reg a, const Reg b) { return pre##_add_##suf(a, b); } \
+		__CuSimd_Target__(target) static Reg Sub(const Reg a, const Reg b) { return pre##_sub_##suf(a, b); } \
+		__CuSimd_Target__(target) static Reg Mul(const Reg a, const Reg b) { return pre##_mul_##suf(a, b); } \
+		__CuSimd_Target__(target) static Reg Div(const Reg a, const Reg b) { return pre##_div_##suf(a, b); } \
+		__CuSimd_Target__(target) static Reg Min(const Reg x, const Reg m) { return minOp; }                 \
+		__CuSimd_Target__(target) static Reg Max(const Reg x, const Reg m) { return maxOp; }                 \
+		__CuSimd_Target__(target) static std::uint64_t EqMask(const Reg a, const Reg b)                      \
+		{                                                                                                    \
+			return static_cast<std::uint64_t>(eqMask);                                                       \
+		}                                                                                                    \
+	}
+
+		__CuSimd_FloatVec__(Sse2, "sse2", float, __m128, 4, _mm, ps, _mm_min_ps(x, m), _mm_max_ps(x, m),
+							_mm_movemask_ps(_mm_cmpeq_ps(a, b)));
+		__CuSimd_FloatVec__(Sse2, "sse2", double, __m128d, 2, _mm, pd, _mm_min_pd(x, m), _mm_max_pd(x, m),
+							_mm_movemask_pd(_mm_cmpeq_pd(a, b)));
+		__CuSimd_FloatVec__(Avx2, "avx2", float, __m256, 8, _mm256, ps, _mm256_min_ps(x, m), _mm256_max_ps(x, m),
+							_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ)));
+		__CuSimd_FloatVec__(Avx2, "avx2", double, __m256d, 4, _mm256, pd, _mm256_min_pd(x, m), _mm256_max_pd(x, m),
+							_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ)));
+		// the unmasked _mm512_min/max forms trip -Wmaybe-uninitialized on their undefined passthrough in gcc 12
+		__CuSimd_FloatVec__(Avx512, "avx512f", float, __m512, 16, _mm512, ps,
+							_mm512_mask_min_ps(m, 0xffff, x, m),
+							_mm512_mask_max_ps(m, 0xffff, x, m),
+							_mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ));
+		__CuSimd_FloatVec__(Avx512, "avx512f", double, __m512d, 8, _mm512, pd,
+							_mm512_mask_min_pd(m, 0xff, x, m),
+							_mm512_mask_max_pd(m, 0xff, x, m),
+							_mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ));
+
+#undef __CuSimd_FloatVec__
+
+		template <>
+		struct Vec<Isa::Sse2, std::int32_t>
+		{
+			using Reg = __m128i;
+			static constexpr std::size_t Lanes = 4;
+
+			__CuSimd_Target__("sse2") static Reg Load(const std::int32_t *p)
+			{
+				return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+			}
+
+			__CuSimd_Target__("sse2") static void Store(std::int32_t *p, const Reg a)
+			{
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(p), a);
+			}
+
+			__CuSimd_Target__("sse2") static Reg Set1(const std::int32_t v)
+			{
+				return _mm_set1_epi32(v);
+			}
+
+			__CuSimd_Target__("sse2") static Reg Add(const Reg a, const Reg b)
+			{
+				return _mm_add_epi32(a, b);
+			}
+
+			__CuSimd_Target__("sse2") static Reg Sub(const Reg a, const Reg b)
+			{
+				return _mm_sub_epi32(a, b);
+			}
+
+			// SSE2 has no 32 bit mullo, multiply the even and odd lanes separately and interleave the low halves
+			__CuSimd_Target__("sse2") static Reg Mul(const Reg a, const Reg b)
+			{
+				const auto even = _mm_mul_epu32(a, b);
+				const auto odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+				return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+										  _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+			}
+
+			__CuSimd_Target__("sse2") static Reg Min(const Reg x, const Reg m)
+			{
+				const auto lt = _mm_cmplt_epi32(x, m);
+				return _mm_or_si128(_mm_and_si128(lt, x), _mm_andnot_si128(lt, m));
+			}
+
+			__CuSimd_Target__("sse2") static Reg Max(const Reg x, const Reg m)
+			{
+				const auto gt = _mm_cmpgt_epi32(x, m);
+				return _mm_or_si128(_mm_and_si128(gt, x), _mm_andnot_si128(gt, m));
+			}
+
+			__CuSimd_Target__("sse2") static std::uint64_t EqMask(const Reg a, const Reg b)
+			{
+				return static_cast<std::uint64_t>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b))));
+			}
+		};
+
+		template <>
+		struct Vec<Isa::Avx2, std::int32_t>
+		{
+			using Reg = __m256i;
+			static constexpr std::size_t Lanes = 8;
+
+			__CuSimd_Target__("avx2") static Reg Load(const std::int32_t *p)
+			{
+				return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+			}
+
+			__CuSimd_Target__("avx2") static void Store(std::int32_t *p, const Reg a)
+			{
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(p), a);
+			}
+
+			__CuSimd_Target__("avx2") static Reg Set1(const std::int32_t v)
+			{
+				return _mm256_set1_epi32(v);
+			}
+
+			__CuSimd_Target__("avx2") static Reg Add(const Reg a, const Reg b)
+			{
+				return _mm256_add_epi32(a, b);
+			}
+
+			__CuSimd_Target__("avx2") static Reg Sub(const Reg a, const Reg b)
+			{
+				return _mm256_sub_epi32(a, b);
+			}
+
+			__CuSimd_Target__("avx2") static Reg Mul(const Reg a, const Reg b)
+			{
+				return _mm256_mullo_epi32(a, b);
+			}
+
+			__CuSimd_Target__("avx2") static Reg Min(const Reg x, const Reg m)
+			{
+				return _mm256_min_epi32(x, m);
+			}
+
+			__CuSimd_Target__("avx2") static Reg Max(const Reg x, const Reg m)
+			{
+				return _mm256_max_epi32(x, m);
+			}
+
+			__CuSimd_Target__("avx2") static std::uint64_t EqMask(const Reg a, const Reg b)
+			{
+				return static_cast<std::uint64_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b))));
+			}
+		};
+
+		template <>
+		struct Vec<Isa::Avx512, std::int32_t>
+		{
+			using Reg = __m512i;
+			static constexpr std::size_t Lanes = 16;
+
+			__CuSimd_Target__("avx512f") static Reg Load(const std::int32_t *p)
+			{
+				return _mm512_loadu_si512(p);
+			}
+
+			__CuSimd_Target__("avx512f") static void Store(std::int32_t *p, const Reg a)
+			{
+				_mm512_storeu_si512(p, a);
+			}
+
+			__CuSimd_Target__("avx512f") static Reg Set1(const std::int32_t v)
+			{
+				return _mm512_set1_epi32(v);
+			}
+
+			__CuSimd_Target__("avx512f") static Reg Add(const Reg a, const Reg b)
+			{
+				return _mm512_add_epi32(a, b);
+			}
+
+			__CuSimd_Target__("avx512f") static Reg Sub(const Reg a, const Reg b)
+			{
+				return _mm512_sub_epi32(a, b);
+			}
+
+			__CuSimd_Target__("avx512f") static Reg Mul(const Reg a, const Reg b)
+			{
+				return _mm512_mullo_epi32(a, b);
+			}
+
+			__CuSimd_Target__("avx512f") static Reg Min(const Reg x, const Reg m)
+			{
+				return _mm512_mask_min_epi32(m, 0xffff, x, m);
+			}
+
+			__CuSimd_Target__("avx512f") static Reg Max(const Reg x, const Reg m)
+			{
+				return _mm512_mask_max_epi32(m, 0xffff, x, m);
+			}
+
+			__CuSimd_Target__("avx512f") static std::uint64_t EqMask(const Reg a, const Reg b)
+			{
+				return static_cast<std::uint64_t>(_mm512_cmpeq_epi32_mask(a, b));
+			}
+		};
+#endif
+	} // namespace Detail
+} // namespace CuSimd
+
+#define __CuSimd_KernelNs__ Portable
+#define __CuSimd_Kernel__
+#include "Kernels.inl"
+
+#ifdef __CuSimd_Dispatch__
+#define __CuSimd_KernelNs__ Sse2
+#define __CuSimd_Kernel__ __CuSimd_Target__("sse2")
+#include "Kernels.inl"
+
+#define __CuSimd_KernelNs__ Avx2
+#define __CuSimd_Kernel__ __CuSimd_Target__("avx2")
+#include "Kernels.inl"
+
+#define __CuSimd_KernelNs__ Avx512
+#define __CuSimd_Kernel__ __CuSimd_Target__("avx512f")
+#include "Kernels.inl"
+#endif
+
+namespace CuSimd
+{
+	namespace Detail
+	{
+		// call gets the kernels and the register wrappers of the selected isa, it only passes pointers and scalars to them
+		template <typename T, typename Call>
+		auto Dispatch(Call call)
+		{
+			switch (GetIsa())
+			{
+#ifdef __CuSimd_Dispatch__
+			case Isa::Avx512:
+				return call(Avx512::Kernels{}, Vec<Isa::Avx512, T>{});
+			case Isa::Avx2:
+				return call(Avx2::Kernels{}, Vec<Isa::Avx2, T>{});
+			case Isa::Sse2:
+				return call(Sse2::Kernels{}, Vec<Isa::Sse2, T>{});
+#endif
+			default:
+				return call(Portable::Kernels{}, Vec<Isa::Portable, T>{});
+			}
+		}
+	} // namespace Detail
+
+	// floating point results are summed lane wise and may differ from a sequential loop in the last bits
+	template <typename T>
+	T Sum(const T *p, const std::size_t n)
+	{
+		static_assert(IsSupported<T>);
+		return Detail::Dispatch<T>([&](auto k, auto v)
+								 { return decltype(k)::Sum::template Run<decltype(v), T>(p, n); });
+	}
+
+	template <typename T>
+	T Dot(const T *a, const T *b, const std::size_t n)
+	{
+		static_assert(IsSupported<T>);
+		return Detail::Dispatch<T>([&](auto k, auto v)
+								 { return decltype(k)::Dot::template Run<decltype(v), T>(a, b, n); });
+	}
+
+	// n must not be zero
+	template <typename T>
+	T Min(const T *p, const std::size_t n)
+	{
+		static_assert(IsSupported<T>);
+		return Detail::Dispatch<T>([&](auto k, auto v)
+								 { return decltype(k)::Min::template Run<decltype(v), T>(p, n); });
+	}
+
+	template <typename T>
+	T Max(const T *p, const std::size_t n)
+	{
+		static_assert(IsSupported<T>);
+		return Detail::Dispatch<T>([&](auto k, auto v)
+								 { return decltype(k)::Max::template Run<decltype(v), T>(p, n); });
+	}
+
+	// index of the first minimum, the same element std::min_element returns
+	template <typename T>
+	std::size_t ArgMin(const T *p, const std::size_t n)
+	{
+		const auto val = Min(p, n);
+		if (val != val)
+			return 0;
+		return Detail::Dispatch<T>([&](auto k, auto v)
+								 { return decltype(k)::Find::template Run<decltype(v), T>(p, n, val); });
+	}
+
+	template <typename T>
+	std::size_t ArgMax(const T *p, const std::size_t n)
+	{
+		const auto val = Max(p, n);
+		if (val != val)
+			return 0;
+		return Detail::Dispatch<T>([&](auto k, auto v)
+								 { return decltype(k)::Find::template Run<decltype(v), T>(p, n, val); });
+	}
+
+	// out may alias a or b
+	template <typename T, typename Op>
+	void Transform(const T *a, const T *b, T *out, const std::size_t n, Op op)
+	{
+		if constexpr (IsVectorOp<Op, T>)
+			Detail::Dispatch<T>([&](auto k, auto v)
+							   { decltype(k)::template Transform<Op>::template Run<decltype(v), T>(a, b, out, n); });
+		else
+			std::transform(a, a + n, b, out, op);
+	}
+
+	template <typename T, typename Op>
+	void Transform(const T *a, const T s, T *out, const std::size_t n, Op op)
+	{
+		if constexpr (IsVectorOp<Op, T>)
+			Detail::Dispatch<T>([&](auto k, auto v)
+							   { decltype(k)::template Transform<Op>::template Run<decltype(v), T>(a, s, out, n); });
+		else
+			std::transform(a, a + n, out, [&](const T x)
+						   { return op(x, s); });
+	}
+} // namespace CuSimd
+
+#undef __CuSimd_Target__
+#undef __CuSimd_Dispatch__
+#undef __CuSimd_X86__
@@ -38,12 +38,15 @@ namespace CuThread
     public:
         std::size_t DynLimit = 0;
 
-        void Write(T &&data)
+        // returns false and drops data once the channel is closed
+        bool Write(T &&data)
         {
             std::unique_lock lock(mtx);
             if constexpr (Limit)
                 writeCond.wait(lock, [&]()
                                {
+                if (closed)
+                    return true;
                 if constexpr (Limit == Dynamics)
                 {
                     return buffer.size() < DynLimit;
@@ -52,9 +55,12 @@ namespace CuThread
                 {
                     return buffer.size() < Limit;
                 } });
+            if (closed)
+                return false;
             buffer.push_back(std::move(data));
             lock.unlock();
             readCond.notify_all();
+            return true;
         }
 
         template <typename... Args>
@@ -77,6 +83,33 @@ namespace CuThread
             return std::move(item);
         }
 
+        // like Read, but returns std::nullopt instead of blocking once the channel is closed and drained
+        std::optional<T> Receive()
+        {
+            std::unique_lock lock(mtx);
+            readCond.wait(lock, [&]()
+                          { return !buffer.empty() || closed; });
+            if (buffer.empty())
+                return std::nullopt;
+            std::optional<T> item(std::move(buffer.front()));
+            buffer.pop_front();
+            lock.unlock();
+            if constexpr (Limit)
+                writeCond.notify_all();
+            return item;
+        }
+
+        // wakes every blocked reader and writer, items already written can still be received
+        void Close()
+        {
+            {
+                std::lock_guard lock(mtx);
+                closed = true;
+            }
+            readCond.notify_all();
+            writeCond.notify_all();
+        }
+
         [[nodiscard]] auto Length() const
         {
             return buffer.size();
@@ -89,6 +122,7 @@ namespace CuThread
 
     private:
         std::list<T> buffer{};
+        bool closed = false;
         std::mutex mtx{};
         std::condition_variable readCond{};
         std::condition_variable writeCond{};
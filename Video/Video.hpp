@@ -11,6 +11,10 @@
 #include <type_traits>
 #include <thread>
 #include <span>
+#include <memory>
+#include <optional>
+#include <exception>
+#include <cmath>
 
 extern "C"
 {
@@ -19,6 +23,8 @@ extern "C"
 #include <libavcodec/avcodec.h>
 #include <libavutil/avutil.h>
 #include <libavutil/imgutils.h>
+#include <libavutil/opt.h>
+#include <libavutil/pixdesc.h>
 #include <libswscale/swscale.h>
 #include <libswresample/swresample.h>
 }
@@ -29,6 +35,8 @@ extern "C"
 #include "../Convert/Convert.hpp"
 #include "../Log/LogLevel.hpp"
 #include "../Utility/Utility.hpp"
+#include "../Thread/Thread.hpp"
+#include "../File/File.hpp"
 
 namespace CuVid
 {
@@ -169,6 +177,60 @@ namespace CuVid
                 FF_API_EQ_NULL_ALLOC(sws_getCachedContext, "SWS", context, srcW, srcH, srcFormat, dstW, dstH, dstFormat, flags, srcFilter, dstFilter, param);
             }
 
+            inline SwsContext *SwsAllocContext()
+            {
+                FF_API_EQ_NULL_ALLOC(sws_alloc_context, "SWS");
+            }
+
+            inline int SwsInitContext(struct SwsContext *sws_context, SwsFilter *srcFilter, SwsFilter *dstFilter)
+            {
+                FF_API_LESS_0(sws_init_context, sws_context, srcFilter, dstFilter);
+            }
+
+            inline int AvOptSetInt(void *obj, const char *name, int64_t val, int search_flags)
+            {
+                FF_API_LESS_0(av_opt_set_int, obj, name, val, search_flags);
+            }
+
+            struct SwsParams
+            {
+                int SrcW = 0;
+                int SrcH = 0;
+                AVPixelFormat SrcFormat = AV_PIX_FMT_NONE;
+                int DstW = 0;
+                int DstH = 0;
+                AVPixelFormat DstFormat = AV_PIX_FMT_NONE;
+                int Flags = 0;
+                int Threads = 1;
+
+                bool operator==(const SwsParams &) const = default;
+            };
+
+            // sws_getCachedContext can not set "threads", above 1 sws_scale_frame converts horizontal slices in parallel
+            // and 0 uses one thread per core. sws_init_context rewrites some parameters, so callers cache params themselves
+            inline SwsContext *SwsAllocThreadedContext(const SwsParams &params)
+            {
+                auto *context = SwsAllocContext();
+                try
+                {
+                    AvOptSetInt(context, "srcw", params.SrcW, 0);
+                    AvOptSetInt(context, "srch", params.SrcH, 0);
+                    AvOptSetInt(context, "src_format", params.SrcFormat, 0);
+                    AvOptSetInt(context, "dstw", params.DstW, 0);
+                    AvOptSetInt(context, "dsth", params.DstH, 0);
+                    AvOptSetInt(context, "dst_format", params.DstFormat, 0);
+                    AvOptSetInt(context, "sws_flags", params.Flags, 0);
+                    AvOptSetInt(context, "threads", params.Threads, 0);
+                    SwsInitContext(context, nullptr, nullptr);
+                }
+                catch (...)
+                {
+                    sws_freeContext(context);
+                    throw;
+                }
+                return context;
+            }
+
             inline AVFrame *AvFrameAlloc()
             {
                 FF_API_EQ_NULL_ALLOC(av_frame_alloc, "AVFrame", );
@@ -305,6 +367,73 @@ namespace CuVid
                 FF_API_LESS_0(av_dict_set_int, pm, key, value, flags);
             }
 
+            inline int SwrAllocSetOpts2(struct SwrContext **ps,
+                                        const AVChannelLayout *out_ch_layout, enum AVSampleFormat out_sample_fmt, int out_sample_rate,
+                                        const AVChannelLayout *in_ch_layout, enum AVSampleFormat in_sample_fmt, int in_sample_rate,
+                                        int log_offset, void *log_ctx)
+            {
+                FF_API_LESS_0(swr_alloc_set_opts2, ps, out_ch_layout, out_sample_fmt, out_sample_rate,
+                              in_ch_layout, in_sample_fmt, in_sample_rate, log_offset, log_ctx);
+            }
+
+            inline int SwrInit(struct SwrContext *s)
+            {
+                FF_API_LESS_0(swr_init, s);
+            }
+
+            inline int SwrConvert(struct SwrContext *s, uint8_t **out, int out_count, const uint8_t **in, int in_count)
+            {
+                FF_API_LESS_0(swr_convert, s, out, out_count, in, in_count);
+            }
+
+            inline int AvSeekFrame(AVFormatContext *s, int stream_index, int64_t timestamp, int flags)
+            {
+                FF_API_LESS_0(av_seek_frame, s, stream_index, timestamp, flags);
+            }
+
+            inline const AVPixFmtDescriptor *AvPixFmtDescGet(enum AVPixelFormat pix_fmt)
+            {
+                const auto *desc = av_pix_fmt_desc_get(pix_fmt);
+                if (desc == nullptr)
+                    ThrowEx("[av_pix_fmt_desc_get] unknown pixel format<{}>", static_cast<int>(pix_fmt));
+                return desc;
+            }
+
+            // plane 0 already is an 8 bit luma image, so a grayscale view needs no conversion
+            inline bool HasGray8Plane(enum AVPixelFormat pix_fmt)
+            {
+                const auto *desc = AvPixFmtDescGet(pix_fmt);
+                if (desc->flags & (AV_PIX_FMT_FLAG_RGB | AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_HWACCEL))
+                    return false;
+                const auto &luma = desc->comp[0];
+                return luma.plane == 0 && luma.step == 1 && luma.offset == 0 && luma.shift == 0 && luma.depth == 8;
+            }
+
+            inline AVFrame *AvFrameClone(const AVFrame *src)
+            {
+                FF_API_EQ_NULL_ALLOC(av_frame_clone, "AVFrame", src);
+            }
+
+            inline AVBufferPool *AvBufferPoolInit(size_t size, AVBufferRef *(*alloc)(size_t size))
+            {
+                FF_API_EQ_NULL_ALLOC(av_buffer_pool_init, "AVBufferPool", size, alloc);
+            }
+
+            inline AVBufferRef *AvBufferPoolGet(AVBufferPool *pool)
+            {
+                FF_API_EQ_NULL_ALLOC(av_buffer_pool_get, "AVBufferRef", pool);
+            }
+
+            struct PacketDeleter
+            {
+                void operator()(AVPacket *pkt) const
+                {
+                    av_packet_free(&pkt);
+                }
+            };
+
+            using PacketPtr = std::unique_ptr<AVPacket, PacketDeleter>;
+
             class MemoryStream
             {
             public:
@@ -448,22 +577,26 @@ namespace CuVid
 
             class MemoryStreamIoContext
             {
-                static constexpr auto BufferSize = 4096;
-
             public:
+                static constexpr int DefaultBufferSize = 4096;
+
                 MemoryStreamIoContext(MemoryStreamIoContext const &) = delete;
                 MemoryStreamIoContext &operator=(MemoryStreamIoContext const &) = delete;
                 MemoryStreamIoContext(MemoryStreamIoContext &&) = delete;
                 MemoryStreamIoContext &operator=(MemoryStreamIoContext &&) = delete;
 
-                MemoryStreamIoContext(MemoryStream inputStream) : inputStream(std::move(inputStream)),
-                                                                  buffer(static_cast<unsigned char *>(AvMalloc(BufferSize))),
-                                                                  ctx(AvioAllocContext(buffer, BufferSize, 0, this,
-                                                                                       &MemoryStreamIoContext::Read, nullptr, &MemoryStreamIoContext::Seek)) {}
+                MemoryStreamIoContext(MemoryStream inputStream, const int bufferSize = DefaultBufferSize)
+                    : inputStream(std::move(inputStream)),
+                      buffer(static_cast<unsigned char *>(AvMalloc(bufferSize))),
+                      ctx(AvioAllocContext(buffer, bufferSize, 0, this,
+                                           &MemoryStreamIoContext::Read, nullptr, &MemoryStreamIoContext::Seek)) {}
 
                 ~MemoryStreamIoContext()
                 {
-                    av_free(ctx);
+                    // avio may have swapped the buffer it was given for one of its own
+                    if (ctx)
+                        av_freep(&ctx->buffer);
+                    avio_context_free(&ctx);
                 }
 
                 void ResetInnerContext()
@@ -633,6 +766,236 @@ namespace CuVid
         }
     };
 
+    // owns one reference to an AVFrame, copies add a reference to the same buffers instead of copying pixels
+    class FrameRef
+    {
+    public:
+        FrameRef() = default;
+
+        explicit FrameRef(AVFrame *frame) : frame(frame)
+        {
+        }
+
+        ~FrameRef()
+        {
+            av_frame_free(&frame);
+        }
+
+        FrameRef(const FrameRef &ref) : frame(ref.frame ? Detail::AV::AvFrameClone(ref.frame) : nullptr)
+        {
+        }
+
+        FrameRef(FrameRef &&ref) noexcept : frame(std::exchange(ref.frame, nullptr))
+        {
+        }
+
+        FrameRef &operator=(const FrameRef &ref)
+        {
+            if (this == &ref)
+                return *this;
+            auto *newFrame = ref.frame ? Detail::AV::AvFrameClone(ref.frame) : nullptr;
+            av_frame_free(&frame);
+            frame = newFrame;
+            return *this;
+        }
+
+        FrameRef &operator=(FrameRef &&ref) noexcept
+        {
+            if (this == &ref)
+                return *this;
+            av_frame_free(&frame);
+            frame = std::exchange(ref.frame, nullptr);
+            return *this;
+        }
+
+        [[nodiscard]] AVFrame *Get() const { return frame; }
+        [[nodiscard]] AVFrame *operator->() const { return frame; }
+        explicit operator bool() const { return frame != nullptr; }
+
+        [[nodiscard]] int Width() const { return frame->width; }
+        [[nodiscard]] int Height() const { return frame->height; }
+        [[nodiscard]] int64_t Pts() const { return frame->pts; }
+
+        // the view writes through to buffers shared by every copy of this FrameRef
+        template <typename T>
+        [[nodiscard]] CuImg::Image<T, CuImg::Backend::Ref> ToImage() const
+        {
+            CuImg::Image<T, CuImg::Backend::Ref> img{};
+            img.GetContext().SetSource(frame->data[0], frame->width, frame->height, frame->linesize[0]);
+            return img;
+        }
+
+    private:
+        AVFrame *frame = nullptr;
+    };
+
+    struct NativePlane
+    {
+        const uint8_t *Data = nullptr;
+        int Linesize = 0;
+        // bytes of pixel data in a row, Linesize may be larger
+        int RowBytes = 0;
+        int Height = 0;
+    };
+
+    // zero copy view of the planes of a decoded frame, valid while the frame is
+    class NativeFrame
+    {
+    public:
+        NativeFrame() = default;
+
+        explicit NativeFrame(const AVFrame *frame) : NativeFrame(frame, static_cast<AVPixelFormat>(frame->format))
+        {
+        }
+
+        // format reinterprets the leading planes of frame, e.g. AV_PIX_FMT_GRAY8 over the luma plane of a YUV frame
+        NativeFrame(const AVFrame *frame, const AVPixelFormat format) : frame(frame), format(format)
+        {
+            const auto *desc = Detail::AV::AvPixFmtDescGet(format);
+            planeCount = std::min<int>(av_pix_fmt_count_planes(format), static_cast<int>(planes.size()));
+            for (int i = 0; i < planeCount; ++i)
+            {
+                auto &plane = planes[i];
+                plane.Data = frame->data[i];
+                plane.Linesize = frame->linesize[i];
+                plane.RowBytes = av_image_get_linesize(format, frame->width, i);
+                plane.Height = i == 1 || i == 2 ? AV_CEIL_RSHIFT(frame->height, desc->log2_chroma_h) : frame->height;
+            }
+        }
+
+        [[nodiscard]] AVPixelFormat Format() const { return format; }
+        [[nodiscard]] int Width() const { return frame->width; }
+        [[nodiscard]] int Height() const { return frame->height; }
+        [[nodiscard]] int64_t Pts() const { return frame->pts; }
+        [[nodiscard]] const AVFrame *Get() const { return frame; }
+
+        [[nodiscard]] std::span<const NativePlane> Planes() const { return {planes.data(), static_cast<size_t>(planeCount)}; }
+        [[nodiscard]] const NativePlane &Plane(const size_t i) const { return planes.at(i); }
+
+        // keeps the whole underlying frame alive past the handler without copying pixels
+        [[nodiscard]] FrameRef Ref() const
+        {
+            return FrameRef(Detail::AV::AvFrameClone(frame));
+        }
+
+    private:
+        const AVFrame *frame = nullptr;
+        AVPixelFormat format = AV_PIX_FMT_NONE;
+        int planeCount = 0;
+        std::array<NativePlane, 4> planes{};
+    };
+
+    // samples converted by the Decoder, valid until AudioBufferCount more audio frames have been delivered.
+    // interleaved formats have one plane holding every channel, planar ones one plane per channel
+    class AudioFrame
+    {
+    public:
+        AudioFrame(const uint8_t *data, const size_t planeStride, const AVSampleFormat format,
+                   const int sampleRate, const int channels, const int samples, const int64_t pts)
+            : data(data), planeStride(planeStride), format(format),
+              sampleRate(sampleRate), channels(channels), samples(samples), pts(pts)
+        {
+        }
+
+        [[nodiscard]] AVSampleFormat Format() const { return format; }
+        [[nodiscard]] int SampleRate() const { return sampleRate; }
+        [[nodiscard]] int Channels() const { return channels; }
+        [[nodiscard]] int Samples() const { return samples; }
+        [[nodiscard]] int64_t Pts() const { return pts; }
+        [[nodiscard]] bool IsPlanar() const { return av_sample_fmt_is_planar(format); }
+        [[nodiscard]] int PlaneCount() const { return IsPlanar() ? channels : 1; }
+
+        [[nodiscard]] std::span<const uint8_t> Plane(const size_t i) const
+        {
+            if (i >= static_cast<size_t>(PlaneCount()))
+                ThrowEx("AudioFrame::Plane: index {} out of range", i);
+            const auto bytes = static_cast<size_t>(samples) * av_get_bytes_per_sample(format) * (IsPlanar() ? 1 : channels);
+            return {data + i * planeStride, bytes};
+        }
+
+        // S must match Format, e.g. int16_t for AV_SAMPLE_FMT_S16(P) or float for AV_SAMPLE_FMT_FLT(P)
+        template <typename S>
+        [[nodiscard]] std::span<const S> PlaneAs(const size_t i) const
+        {
+            const auto plane = Plane(i);
+            return {reinterpret_cast<const S *>(plane.data()), plane.size() / sizeof(S)};
+        }
+
+    private:
+        const uint8_t *data;
+        size_t planeStride;
+        AVSampleFormat format;
+        int sampleRate;
+        int channels;
+        int samples;
+        int64_t pts;
+    };
+
+    enum class ScaleFilter
+    {
+        FastBilinear,
+        Bilinear,
+        Bicubic,
+        // the best choice for large downscales, e.g. to ML input sizes
+        Area,
+        Point,
+        Lanczos,
+    };
+
+    namespace Detail
+    {
+        inline int GetSwsFlags(const ScaleFilter filter)
+        {
+            switch (filter)
+            {
+            case ScaleFilter::FastBilinear:
+                return SWS_FAST_BILINEAR;
+            case ScaleFilter::Bilinear:
+                return SWS_BILINEAR;
+            case ScaleFilter::Area:
+                return SWS_AREA;
+            case ScaleFilter::Point:
+                return SWS_POINT;
+            case ScaleFilter::Lanczos:
+                return SWS_LANCZOS;
+            default:
+                return SWS_BICUBIC;
+            }
+        }
+
+        // the buffer comes from a pool sized for one frame and returns to it with the last reference,
+        // a frame of another size replaces the pool
+        inline FrameRef AcquirePooledFrame(AVBufferPool *&pool, int &poolSize, const AVPixelFormat format,
+                                           const int width, const int height, const int align)
+        {
+            const auto size = AV::AvImageGetBufferSize(format, width, height, align);
+            if (!pool || poolSize != size)
+            {
+                av_buffer_pool_uninit(&pool);
+                pool = AV::AvBufferPoolInit(size, nullptr);
+                poolSize = size;
+            }
+
+            FrameRef ref(AV::AvFrameAlloc());
+            ref->format = format;
+            ref->width = width;
+            ref->height = height;
+            ref->buf[0] = AV::AvBufferPoolGet(pool);
+            AV::AvImageFillArrays(ref->data, ref->linesize, ref->buf[0]->data, format, width, height, align);
+            return ref;
+        }
+    }
+
+    enum class OutputMode
+    {
+        // packed T through swscale, skipped when the decoder already outputs T at the requested size
+        Convert,
+        // the codec's own planes, no conversion
+        Native,
+        // 8 bit luma, the Y plane itself when the codec outputs 8 bit YUV
+        Gray,
+    };
+
     enum StreamType : int
     {
         StreamTypeNone = 0,
@@ -650,9 +1013,48 @@ namespace CuVid
 
     public:
         using VideoFrameType = CuImg::Image<T, CuImg::Backend::Ref>;
-        using AudioFrameType = std::vector<uint8_t>;
+        using AudioFrameType = AudioFrame;
 
     private:
+        static constexpr int FrameAlign = 64;
+
+        struct PacketItem
+        {
+            Detail::AV::PacketPtr Packet{};
+            std::exception_ptr Error{};
+        };
+
+        struct FrameItem
+        {
+            StreamType Type = StreamTypeNone;
+            FrameRef Frame{};
+            AVPixelFormat ViewFormat = AV_PIX_FMT_NONE;
+            std::exception_ptr Error{};
+        };
+
+        // every stage forwards an item without packet or frame as end of stream and an Error as the last item.
+        // destroying it closes the queues, so stages blocked on a full queue return and can be joined
+        struct Pipeline
+        {
+            CuThread::Channel<PacketItem, CuThread::Dynamics> Packets{};
+            CuThread::Channel<FrameItem, CuThread::Dynamics> Frames{};
+            CuThread::Channel<FrameItem, CuThread::Dynamics> Outputs{};
+
+            std::thread Demuxer{};
+            std::thread Decoder{};
+            std::thread Converter{};
+
+            ~Pipeline()
+            {
+                Packets.Close();
+                Frames.Close();
+                Outputs.Close();
+                for (auto *th : {&Demuxer, &Decoder, &Converter})
+                    if (th->joinable())
+                        th->join();
+            }
+        };
+
         struct Context
         {
             AVFormatContext *fmtCtx = nullptr;
@@ -663,15 +1065,37 @@ namespace CuVid
             AVCodecContext *currentCodecCtx = nullptr;
 
             AVFrame *frame = nullptr;
-            AVFrame *frameBuf = nullptr;
 
             SwsContext *swsCtx = nullptr;
+            Detail::AV::SwsParams swsParams{};
+
+            AVBufferPool *framePool = nullptr;
+            int framePoolSize = 0;
+
+            SwrContext *swrCtx = nullptr;
+            AVChannelLayout swrInLayout{};
+            AVChannelLayout swrOutLayout{};
+            int swrInFormat = AV_SAMPLE_FMT_NONE;
+            int swrInRate = 0;
+            int swrOutRate = 0;
+            std::vector<std::vector<uint8_t>> audioBuffers{};
+            size_t audioBufferIndex = 0;
+            std::vector<uint8_t *> audioPlanes{};
 
             bool FileEof = false;
             bool Eof = false;
 
+            // frames before it are decoded but not delivered, in AV_TIME_BASE units
+            std::optional<int64_t> seekTarget{};
+            int64_t frameIndex = 0;
+            std::optional<double> sampleOrigin{};
+            int64_t lastSample = -1;
+
             Detail::AV::MemoryStream *ms;
             Detail::AV::MemoryStreamIoContext *privCtx;
+            std::shared_ptr<const CuFile::MappedFile> mappedFile{};
+
+            std::unique_ptr<Pipeline> pipeline{};
         } Ctx{};
 
     public:
@@ -683,20 +1107,63 @@ namespace CuVid
 
             using FilePath = std::filesystem::path;
             using MemoryFile = std::span<const uint8_t>;
-            std::variant<FilePath, MemoryFile> Input{};
+            // read-only mapping, one can feed any number of decoders and is kept alive until Reset
+            using MappedFile = std::shared_ptr<const CuFile::MappedFile>;
+            std::variant<FilePath, MemoryFile, MappedFile> Input{};
+
+            // AVIO buffer of MemoryFile and MappedFile, every refill is one read callback
+            int IoBufferSize = 512 * 1024;
+            // asks the kernel to read a MappedFile ahead sequentially
+            bool ReadAhead = true;
 
             std::optional<U8String> FormatName{};
             FlagDictionary Options{};
             std::optional<std::variant<AVCodecID, U8String>> CodecIdOrName{};
 
+            // output size of Convert and Gray, a missing one follows the aspect ratio of the source
             std::optional<int> VideoHeight{};
             std::optional<int> VideoWidth{};
+            ScaleFilter Filter = ScaleFilter::Bicubic;
+            // lets a codec with lowres support (e.g. mjpeg, h263) decode at 1/2, 1/4 or 1/8 size when the output is
+            // at least that small. Native frames come out at the reduced size
+            bool Lowres = true;
+
+            // slice threads of the swscale conversion, 0 uses one per core
+            int ConvertThreads = 1;
+
+            // only keyframes are read and decoded, the packets between them are dropped before the codec
+            bool KeyframeOnly = false;
+            // delivers every FrameStep-th video frame
+            int FrameStep = 1;
+            // delivers at most SampleFps video frames per second of stream time
+            std::optional<double> SampleFps{};
+            // FrameStep and SampleFps let the codec discard non-reference frames, so they count and pick among the rest
 
             int VideoIndex = -1;
             int AudioIndex = -1;
 
+            // Read runs demuxing, decoding and conversion on three threads joined by bounded queues,
+            // handlers still run on the thread calling Read. Config must not change until Eof
+            bool Pipelined = false;
+            size_t PacketQueueSize = 64;
+            size_t FrameQueueSize = 4;
+
+            OutputMode Output = OutputMode::Convert;
+
+            // Convert mode
             std::function<void(VideoFrameType &)> VideoHandler = nullptr;
-            std::function<void(AudioFrameType)> AudioHandler = nullptr;
+            // receives the converted frame itself, keeping the FrameRef keeps its pooled buffer out of reuse
+            std::function<void(FrameRef)> VideoFrameHandler = nullptr;
+            // Native and Gray modes
+            std::function<void(const NativeFrame &)> NativeHandler = nullptr;
+
+            // audio is converted with libswresample on the thread calling Read, missing rate and channels keep the source's
+            AVSampleFormat AudioSampleFormat = AV_SAMPLE_FMT_S16;
+            std::optional<int> AudioSampleRate{};
+            std::optional<int> AudioChannels{};
+            // converted frames rotate through this many reused buffers
+            size_t AudioBufferCount = 4;
+            std::function<void(const AudioFrameType &)> AudioHandler = nullptr;
         } Config{};
 
         Decoder()
@@ -709,8 +1176,10 @@ namespace CuVid
         }
 
         Decoder(const Decoder &) = delete;
+        // moving stops the pipeline of dec, frames it had queued are dropped
         Decoder(Decoder &&dec) noexcept
         {
+            dec.Ctx.pipeline.reset();
             Ctx = std::move(dec.Ctx);
             Config = std::move(dec.Config);
             dec.Ctx = {};
@@ -721,6 +1190,7 @@ namespace CuVid
         Decoder &operator=(Decoder &&dec) noexcept
         {
             Reset();
+            dec.Ctx.pipeline.reset();
             Ctx = std::move(dec.Ctx);
             Config = std::move(dec.Config);
             dec.Ctx = {};
@@ -739,16 +1209,34 @@ namespace CuVid
             
             std::optional<std::u8string> url{};
 
+            const auto openMemory = [&](const uint8_t *data, const uint64_t size)
+            {
+                if (Config.IoBufferSize <= 0)
+                    ThrowEx("IoBufferSize must be positive");
+
+                Ctx.ms = new AV::MemoryStream(data, size, false);
+                Ctx.privCtx = new AV::MemoryStreamIoContext(*Ctx.ms, Config.IoBufferSize);
+
+                Ctx.fmtCtx = AV::AvformatAllocContext();
+                Ctx.fmtCtx->pb = Ctx.privCtx->GetAvio();
+            };
+
             std::visit(CuUtil::Variant::Visitor{[&](const typename DecoderConfig::FilePath &path)
                                   {
                                       url = path.u8string();
                                   },
                                   [&](typename DecoderConfig::MemoryFile &file)
                                   {
-                                      Ctx.ms = new AV::MemoryStream(file.data(), file.size_bytes(), false);
-                                      Ctx.privCtx = new AV::MemoryStreamIoContext(*Ctx.ms);
-
-                                      Ctx.fmtCtx->pb = Ctx.privCtx->GetAvio();
+                                      openMemory(file.data(), file.size_bytes());
+                                  },
+                                  [&](const typename DecoderConfig::MappedFile &file)
+                                  {
+                                      if (!file)
+                                          ThrowEx("MappedFile is null");
+                                      Ctx.mappedFile = file;
+                                      if (Config.ReadAhead)
+                                          file->Advise(CuFile::MapAccess::Sequential);
+                                      openMemory(file->Data(), file->Size());
                                   }},
                        Config.Input);
 
@@ -776,7 +1264,6 @@ namespace CuVid
 
             Ctx.pkt = AV::AvPacketAlloc();
             Ctx.frame = AV::AvFrameAlloc();
-            Ctx.frameBuf = AV::AvFrameAlloc();
         }
 
         bool TrySendFrame()
@@ -793,11 +1280,7 @@ namespace CuVid
                 ThrowEx("[av_read_frame] {}", AV::AvStrError(ret));
             }
 
-            Ctx.currentCodecCtx = nullptr;
-            if (Ctx.pkt->stream_index == Config.VideoIndex)
-                Ctx.currentCodecCtx = Ctx.videoCtx;
-            else if (Ctx.pkt->stream_index == Config.AudioIndex)
-                Ctx.currentCodecCtx = Ctx.audioCtx;
+            Ctx.currentCodecCtx = Ctx.FileEof || WantPacket(Ctx.pkt) ? CodecOf(Ctx.pkt->stream_index) : nullptr;
 
             if (Ctx.currentCodecCtx)
             {
@@ -844,37 +1327,25 @@ namespace CuVid
 
                 if (Ctx.currentCodecCtx->codec->type == AVMEDIA_TYPE_VIDEO)
                 {
-                    constexpr auto DstPixFmt = Detail::CuImgTypeToFFmpegType<T>{}();
-
-                    const auto w = Config.VideoWidth ? *Config.VideoWidth : Ctx.currentCodecCtx->width;
-                    const auto h = Config.VideoHeight ? *Config.VideoHeight : Ctx.currentCodecCtx->height;
-                  
-                    VideoFrameType buf{};
-
-                    Ctx.frameBuf->format = DstPixFmt;
-                    Ctx.frameBuf->width = w;
-                    Ctx.frameBuf->height = h;
-                    Ctx.swsCtx = AV::SwsGetCachedContext(
-                        Ctx.swsCtx, w, h, Ctx.currentCodecCtx->pix_fmt,
-                        w, h, DstPixFmt, 0, nullptr, nullptr, nullptr);
-                    const auto ret = sws_scale_frame(Ctx.swsCtx, Ctx.frameBuf, Ctx.frame);
-                    if (ret < 0)
-                        ThrowEx("[sws_scale_frame] {}", AV::AvStrError(ret));
-
-                    buf.GetContext().SetSource(Ctx.frameBuf->data[0], Ctx.frameBuf->width, Ctx.frameBuf->height, Ctx.frameBuf->linesize[0]);
-
-                    result = StreamTypeVideo;
-                    if (Config.VideoHandler)
-                        Config.VideoHandler(buf);
+                    if (SelectFrame(StreamTypeVideo, Ctx.frame))
+                    {
+                        result = StreamTypeVideo;
+                        if (HasVideoHandler())
+                        {
+                            FrameRef frame(AV::AvFrameAlloc());
+                            av_frame_move_ref(frame.Get(), Ctx.frame);
+                            auto item = PrepareVideo(std::move(frame));
+                            InvokeVideo(item);
+                        }
+                    }
                 }
-                else if (Ctx.currentCodecCtx->codec->type == AVMEDIA_TYPE_AUDIO)
+                else if (Ctx.currentCodecCtx->codec->type == AVMEDIA_TYPE_AUDIO && SelectFrame(StreamTypeAudio, Ctx.frame))
                 {
                     result = StreamTypeAudio;
-                    // Config.AudioHandler(Ctx.frame->data[0], Ctx.frame->linesize[0]);
-                    // Ctx.Result = AudioFrameType{};
+                    if (Config.AudioHandler)
+                        InvokeAudio(Ctx.frame);
                 }
 
-                av_frame_unref(Ctx.frameBuf);
                 av_frame_unref(Ctx.frame);
                 av_packet_unref(Ctx.pkt);
             }
@@ -896,6 +1367,9 @@ namespace CuVid
         {
             using namespace Detail;
 
+            if (Config.Pipelined)
+                return ReadPipelined();
+
             while (!Eof())
             {
                 if (!Ctx.FileEof)
@@ -906,14 +1380,51 @@ namespace CuVid
                 }
             }
 
+            FlushAudio();
             return StreamTypeNone;
         }
 
+        // lands on the keyframe at or before pts, in the time base of the video stream or of the audio one without video.
+        // accurate decodes forward from there and delivers nothing before pts
+        void SeekTo(const int64_t pts, const bool accurate = false)
+        {
+            using namespace Detail;
+
+            Ctx.pipeline.reset();
+
+            const auto streamIndex = Ctx.videoCtx ? Config.VideoIndex : Config.AudioIndex;
+            AV::AvSeekFrame(Ctx.fmtCtx, streamIndex, pts, AVSEEK_FLAG_BACKWARD);
+            for (auto *codecCtx : {Ctx.videoCtx, Ctx.audioCtx})
+                if (codecCtx)
+                    avcodec_flush_buffers(codecCtx);
+
+            av_packet_unref(Ctx.pkt);
+            av_frame_unref(Ctx.frame);
+            // the resampler's delayed samples belong to the old position, so they are dropped rather than flushed
+            swr_free(&Ctx.swrCtx);
+            Ctx.currentCodecCtx = nullptr;
+            Ctx.FileEof = false;
+            Ctx.Eof = false;
+
+            Ctx.seekTarget.reset();
+            if (accurate)
+                Ctx.seekTarget = av_rescale_q(pts, Ctx.fmtCtx->streams[streamIndex]->time_base, AVRational{1, AV_TIME_BASE});
+            Ctx.frameIndex = 0;
+            Ctx.sampleOrigin.reset();
+            Ctx.lastSample = -1;
+        }
+
         void Reset()
         {
+            Ctx.pipeline.reset();
+
             sws_freeContext(Ctx.swsCtx);
+            // buffers still held by a FrameRef free themselves once released
+            av_buffer_pool_uninit(&Ctx.framePool);
+            swr_free(&Ctx.swrCtx);
+            av_channel_layout_uninit(&Ctx.swrInLayout);
+            av_channel_layout_uninit(&Ctx.swrOutLayout);
 
-            av_frame_free(&Ctx.frameBuf);
             av_frame_free(&Ctx.frame);
             av_packet_free(&Ctx.pkt);
 
@@ -931,6 +1442,410 @@ namespace CuVid
         }
 
     private:
+        [[nodiscard]] bool HasVideoHandler() const
+        {
+            if (Config.Output == OutputMode::Convert)
+                return Config.VideoHandler || Config.VideoFrameHandler;
+            return static_cast<bool>(Config.NativeHandler);
+        }
+
+        [[nodiscard]] std::pair<int, int> OutputSize(const int srcW, const int srcH) const
+        {
+            const auto scale = [](const int x, const int num, const int den)
+            {
+                return std::max(1, static_cast<int>(std::lround(static_cast<double>(x) * num / den)));
+            };
+
+            if (Config.VideoWidth && Config.VideoHeight)
+                return {*Config.VideoWidth, *Config.VideoHeight};
+            if (Config.VideoWidth)
+                return {*Config.VideoWidth, scale(srcH, *Config.VideoWidth, srcW)};
+            if (Config.VideoHeight)
+                return {scale(srcW, *Config.VideoHeight, srcH), *Config.VideoHeight};
+            return {srcW, srcH};
+        }
+
+        [[nodiscard]] bool HasOutputSize(const AVFrame *frame) const
+        {
+            return OutputSize(frame->width, frame->height) == std::pair(frame->width, frame->height);
+        }
+
+        // the conversion stage, frame is passed through when it already is the output
+        FrameItem PrepareVideo(FrameRef frame)
+        {
+            using namespace Detail;
+
+            FrameItem item{StreamTypeVideo};
+            const auto format = static_cast<AVPixelFormat>(frame->format);
+            switch (Config.Output)
+            {
+            case OutputMode::Native:
+                item.ViewFormat = format;
+                item.Frame = std::move(frame);
+                break;
+
+            case OutputMode::Gray:
+                item.ViewFormat = AV_PIX_FMT_GRAY8;
+                if (HasOutputSize(frame.Get()) && AV::HasGray8Plane(format))
+                    item.Frame = std::move(frame);
+                else
+                    item.Frame = ConvertFrame(frame.Get(), AV_PIX_FMT_GRAY8);
+                break;
+
+            default:
+                item.ViewFormat = CuImgTypeToFFmpegType<T>{}();
+                // the handlers get a writable view, frames the codec still references are copied by the conversion
+                if (format == item.ViewFormat && HasOutputSize(frame.Get()) && av_frame_is_writable(frame.Get()))
+                    item.Frame = std::move(frame);
+                else
+                    item.Frame = ConvertFrame(frame.Get(), item.ViewFormat);
+                break;
+            }
+            return item;
+        }
+
+        void InvokeVideo(FrameItem &item)
+        {
+            if (!item.Frame)
+                return;
+
+            if (Config.Output == OutputMode::Convert)
+            {
+                if (Config.VideoHandler)
+                {
+                    auto buf = item.Frame.template ToImage<T>();
+                    Config.VideoHandler(buf);
+                }
+                if (Config.VideoFrameHandler)
+                    Config.VideoFrameHandler(std::move(item.Frame));
+            }
+            else if (Config.NativeHandler)
+            {
+                Config.NativeHandler(NativeFrame(item.Frame.Get(), item.ViewFormat));
+            }
+        }
+
+        // audio is converted here rather than in the pipeline, so the ring buffers are only touched by the thread calling Read
+        void InvokeAudio(const AVFrame *frame)
+        {
+            using namespace Detail;
+
+            EnsureResampler(frame);
+            const auto maxSamples = swr_get_out_samples(Ctx.swrCtx, frame->nb_samples);
+            if (maxSamples < 0)
+                ThrowEx("[swr_get_out_samples] {}", AV::AvStrError(maxSamples));
+
+            size_t planeStride = 0;
+            auto **out = NextAudioBuffer(maxSamples, planeStride);
+            const auto n = AV::SwrConvert(Ctx.swrCtx, out, maxSamples, const_cast<const uint8_t **>(frame->extended_data), frame->nb_samples);
+            if (n > 0)
+                Config.AudioHandler(AudioFrame(out[0], planeStride, Config.AudioSampleFormat, Ctx.swrOutRate,
+                                               Ctx.swrOutLayout.nb_channels, n, frame->pts));
+        }
+
+        // hands over the samples the resampler still holds, at the end of the stream or before it is rebuilt
+        void FlushAudio()
+        {
+            using namespace Detail;
+
+            if (!Ctx.swrCtx || !Config.AudioHandler)
+                return;
+            const auto delay = swr_get_out_samples(Ctx.swrCtx, 0);
+            if (delay <= 0)
+                return;
+
+            size_t planeStride = 0;
+            auto **out = NextAudioBuffer(delay, planeStride);
+            const auto n = AV::SwrConvert(Ctx.swrCtx, out, delay, nullptr, 0);
+            if (n > 0)
+                Config.AudioHandler(AudioFrame(out[0], planeStride, Config.AudioSampleFormat, Ctx.swrOutRate,
+                                               Ctx.swrOutLayout.nb_channels, n, AV_NOPTS_VALUE));
+        }
+
+        void EnsureResampler(const AVFrame *frame)
+        {
+            using namespace Detail;
+
+            if (Ctx.swrCtx && frame->format == Ctx.swrInFormat && frame->sample_rate == Ctx.swrInRate &&
+                av_channel_layout_compare(&frame->ch_layout, &Ctx.swrInLayout) == 0)
+                return;
+
+            FlushAudio();
+            swr_free(&Ctx.swrCtx);
+            Ctx.swrInFormat = AV_SAMPLE_FMT_NONE;
+
+            av_channel_layout_uninit(&Ctx.swrOutLayout);
+            if (Config.AudioChannels)
+                av_channel_layout_default(&Ctx.swrOutLayout, *Config.AudioChannels);
+            else
+                AV::AvChannelLayoutCopy(&Ctx.swrOutLayout, &frame->ch_layout);
+            Ctx.swrOutRate = Config.AudioSampleRate.value_or(frame->sample_rate);
+
+            AV::SwrAllocSetOpts2(&Ctx.swrCtx, &Ctx.swrOutLayout, Config.AudioSampleFormat, Ctx.swrOutRate,
+                                 &frame->ch_layout, static_cast<AVSampleFormat>(frame->format), frame->sample_rate, 0, nullptr);
+            AV::SwrInit(Ctx.swrCtx);
+
+            av_channel_layout_uninit(&Ctx.swrInLayout);
+            AV::AvChannelLayoutCopy(&Ctx.swrInLayout, &frame->ch_layout);
+            Ctx.swrInFormat = frame->format;
+            Ctx.swrInRate = frame->sample_rate;
+        }
+
+        // the next buffer of the ring, grown to hold samples output samples, and pointers to its planes
+        uint8_t **NextAudioBuffer(const int samples, size_t &planeStride)
+        {
+            const auto format = Config.AudioSampleFormat;
+            const auto channels = Ctx.swrOutLayout.nb_channels;
+            const auto planar = av_sample_fmt_is_planar(format);
+            const auto planes = planar ? channels : 1;
+            planeStride = static_cast<size_t>(samples) * av_get_bytes_per_sample(format) * (planar ? 1 : channels);
+
+            Ctx.audioBuffers.resize(std::max<size_t>(Config.AudioBufferCount, 1));
+            auto &buf = Ctx.audioBuffers[Ctx.audioBufferIndex++ % Ctx.audioBuffers.size()];
+            if (buf.size() < planeStride * planes)
+                buf.resize(planeStride * planes);
+
+            Ctx.audioPlanes.resize(planes);
+            for (int i = 0; i < planes; ++i)
+                Ctx.audioPlanes[i] = buf.data() + i * planeStride;
+            return Ctx.audioPlanes.data();
+        }
+
+        StreamType ReadPipelined()
+        {
+            if (Ctx.Eof)
+                return StreamTypeNone;
+            if (!Ctx.pipeline)
+                StartPipeline();
+
+            auto item = Ctx.pipeline->Outputs.Receive();
+            if (!item || item->Type == StreamTypeNone)
+            {
+                Ctx.Eof = true;
+                Ctx.pipeline.reset();
+                if (item && item->Error)
+                    std::rethrow_exception(item->Error);
+                FlushAudio();
+                return StreamTypeNone;
+            }
+
+            if (item->Type == StreamTypeVideo)
+                InvokeVideo(*item);
+            else if (item->Type == StreamTypeAudio && Config.AudioHandler)
+                InvokeAudio(item->Frame.Get());
+            return item->Type;
+        }
+
+        void StartPipeline()
+        {
+            auto pipe = std::make_unique<Pipeline>();
+            pipe->Packets.DynLimit = std::max<size_t>(Config.PacketQueueSize, 1);
+            pipe->Frames.DynLimit = std::max<size_t>(Config.FrameQueueSize, 1);
+            pipe->Outputs.DynLimit = std::max<size_t>(Config.FrameQueueSize, 1);
+
+            auto *p = pipe.get();
+            pipe->Demuxer = std::thread([this, p]()
+                                        { DemuxStage(*p); });
+            pipe->Decoder = std::thread([this, p]()
+                                        { DecodeStage(*p); });
+            pipe->Converter = std::thread([this, p]()
+                                          { ConvertStage(*p); });
+            Ctx.pipeline = std::move(pipe);
+        }
+
+        [[nodiscard]] AVCodecContext *CodecOf(const int streamIndex) const
+        {
+            if (streamIndex == Config.VideoIndex)
+                return Ctx.videoCtx;
+            if (streamIndex == Config.AudioIndex)
+                return Ctx.audioCtx;
+            return nullptr;
+        }
+
+        [[nodiscard]] bool WantPacket(const AVPacket *pkt) const
+        {
+            if (CodecOf(pkt->stream_index) == nullptr)
+                return false;
+            return !(Config.KeyframeOnly && pkt->stream_index == Config.VideoIndex && !(pkt->flags & AV_PKT_FLAG_KEY));
+        }
+
+        // runs before conversion, so frames skipped by seeking or sampling are never converted
+        bool SelectFrame(const StreamType type, const AVFrame *frame)
+        {
+            const auto *st = Ctx.fmtCtx->streams[type == StreamTypeVideo ? Config.VideoIndex : Config.AudioIndex];
+            const auto ts = frame->best_effort_timestamp != AV_NOPTS_VALUE ? frame->best_effort_timestamp : frame->pts;
+
+            if (Ctx.seekTarget && ts != AV_NOPTS_VALUE && av_rescale_q(ts, st->time_base, AVRational{1, AV_TIME_BASE}) < *Ctx.seekTarget)
+                return false;
+            if (type != StreamTypeVideo)
+                return true;
+
+            if (Config.FrameStep > 1 && Ctx.frameIndex++ % Config.FrameStep != 0)
+                return false;
+            if (Config.SampleFps && ts != AV_NOPTS_VALUE)
+            {
+                // the first frame of each 1 / SampleFps slot counted from the first selected frame
+                const auto t = static_cast<double>(ts) * av_q2d(st->time_base);
+                if (!Ctx.sampleOrigin)
+                    Ctx.sampleOrigin = t;
+                const auto slot = static_cast<int64_t>(std::floor((t - *Ctx.sampleOrigin) * *Config.SampleFps + 1e-6));
+                if (slot <= Ctx.lastSample)
+                    return false;
+                Ctx.lastSample = slot;
+            }
+            return true;
+        }
+
+        void DemuxStage(Pipeline &pipe)
+        {
+            using namespace Detail;
+
+            try
+            {
+                while (true)
+                {
+                    AV::PacketPtr pkt(AV::AvPacketAlloc());
+                    const auto ret = av_read_frame(Ctx.fmtCtx, pkt.get());
+                    if (ret == AVERROR_EOF)
+                        break;
+                    if (ret < 0)
+                        ThrowEx("[av_read_frame] {}", AV::AvStrError(ret));
+
+                    if (!WantPacket(pkt.get()))
+                        continue;
+                    if (!pipe.Packets.Write(PacketItem{std::move(pkt)}))
+                        return;
+                }
+                pipe.Packets.Write(PacketItem{});
+            }
+            catch (...)
+            {
+                pipe.Packets.Write(PacketItem{nullptr, std::current_exception()});
+            }
+        }
+
+        void DecodeStage(Pipeline &pipe)
+        {
+            using namespace Detail;
+
+            try
+            {
+                FrameRef frame(AV::AvFrameAlloc());
+                while (true)
+                {
+                    auto item = pipe.Packets.Receive();
+                    if (!item)
+                        return;
+                    if (item->Error)
+                    {
+                        pipe.Frames.Write(FrameItem{.Error = item->Error});
+                        return;
+                    }
+                    if (!item->Packet)
+                        break;
+
+                    auto *codecCtx = CodecOf(item->Packet->stream_index);
+                    AV::AvcodecSendPacket(codecCtx, item->Packet.get());
+                    if (!DrainCodec(pipe, codecCtx, frame))
+                        return;
+                }
+
+                for (auto *codecCtx : {Ctx.videoCtx, Ctx.audioCtx})
+                {
+                    if (!codecCtx)
+                        continue;
+                    AV::AvcodecSendPacket(codecCtx, nullptr);
+                    if (!DrainCodec(pipe, codecCtx, frame))
+                        return;
+                }
+                pipe.Frames.Write(FrameItem{});
+            }
+            catch (...)
+            {
+                pipe.Frames.Write(FrameItem{.Error = std::current_exception()});
+            }
+        }
+
+        // frame is the spare the codec decodes into, a new one replaces it after each frame sent downstream
+        bool DrainCodec(Pipeline &pipe, AVCodecContext *codecCtx, FrameRef &frame)
+        {
+            using namespace Detail;
+
+            const auto type = codecCtx->codec->type == AVMEDIA_TYPE_VIDEO ? StreamTypeVideo : StreamTypeAudio;
+            while (true)
+            {
+                const auto ret = avcodec_receive_frame(codecCtx, frame.Get());
+                if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
+                    return true;
+                if (ret < 0)
+                    ThrowEx("[avcodec_receive_frame] Error during decoding: {}", AV::AvStrError(ret));
+
+                if (!SelectFrame(type, frame.Get()))
+                {
+                    av_frame_unref(frame.Get());
+                    continue;
+                }
+                if (!pipe.Frames.Write(FrameItem{type, std::move(frame)}))
+                    return false;
+                frame = FrameRef(AV::AvFrameAlloc());
+            }
+        }
+
+        void ConvertStage(Pipeline &pipe)
+        {
+            try
+            {
+                const auto convert = HasVideoHandler();
+                while (true)
+                {
+                    auto item = pipe.Frames.Receive();
+                    if (!item)
+                        return;
+                    if (item->Type == StreamTypeVideo && convert)
+                        item = PrepareVideo(std::move(item->Frame));
+
+                    const auto end = item->Type == StreamTypeNone;
+                    if (!pipe.Outputs.Write(std::move(*item)) || end)
+                        return;
+                }
+            }
+            catch (...)
+            {
+                pipe.Outputs.Write(FrameItem{.Error = std::current_exception()});
+            }
+        }
+
+        FrameRef ConvertFrame(const AVFrame *src, const AVPixelFormat format)
+        {
+            using namespace Detail;
+
+            const auto [w, h] = OutputSize(src->width, src->height);
+
+            auto dst = AcquireFrame(format, w, h);
+            const AV::SwsParams params{src->width, src->height, static_cast<AVPixelFormat>(src->format),
+                                       w, h, format, GetSwsFlags(Config.Filter), Config.ConvertThreads};
+            if (!Ctx.swsCtx || Ctx.swsParams != params)
+            {
+                sws_freeContext(Ctx.swsCtx);
+                Ctx.swsCtx = nullptr;
+                Ctx.swsCtx = AV::SwsAllocThreadedContext(params);
+                Ctx.swsParams = params;
+            }
+            const auto ret = sws_scale_frame(Ctx.swsCtx, dst.Get(), src);
+            if (ret < 0)
+                ThrowEx("[sws_scale_frame] {}", AV::AvStrError(ret));
+            dst->pts = src->pts;
+            dst->pkt_dts = src->pkt_dts;
+            dst->best_effort_timestamp = src->best_effort_timestamp;
+            return dst;
+        }
+
+        // steady state decoding allocates no pixel memory
+        FrameRef AcquireFrame(const AVPixelFormat format, const int width, const int height)
+        {
+            return Detail::AcquirePooledFrame(Ctx.framePool, Ctx.framePoolSize, format, width, height, FrameAlign);
+        }
+
         int OpenCodecContext(AVCodecContext **dec_ctx, AVFormatContext *fmt_ctx, enum AVMediaType type, int idx = -1)
         {
             using namespace Detail::AV;
@@ -959,6 +1874,26 @@ namespace CuVid
                 }
             }
 
+            if (type == AVMEDIA_TYPE_VIDEO)
+            {
+                // the largest reduction that still decodes at least the output size
+                const auto srcW = st->codecpar->width;
+                const auto srcH = st->codecpar->height;
+                if (Config.Lowres && (Config.VideoWidth || Config.VideoHeight) && srcW > 0 && srcH > 0)
+                {
+                    const auto [w, h] = OutputSize(srcW, srcH);
+                    int lowres = 0;
+                    while (lowres < dec->max_lowres && (srcW >> (lowres + 1)) >= w && (srcH >> (lowres + 1)) >= h)
+                        ++lowres;
+                    (*dec_ctx)->lowres = lowres;
+                }
+
+                if (Config.KeyframeOnly)
+                    (*dec_ctx)->skip_frame = AVDISCARD_NONKEY;
+                else if (Config.FrameStep > 1 || Config.SampleFps)
+                    (*dec_ctx)->skip_frame = AVDISCARD_NONREF;
+            }
+
             AvcodecOpen2(*dec_ctx, dec, Config.Options.Clone().AddressOf());
 
             return idx;
@@ -991,6 +1926,10 @@ namespace CuVid
         struct VideoStream : Stream
         {
             SwsContext *sws_ctx = nullptr;
+
+            // frames converted to the codec's format
+            AVBufferPool *pool = nullptr;
+            int poolSize = 0;
         };
 
         struct AudioStream : Stream
@@ -1002,6 +1941,29 @@ namespace CuVid
             SwrContext *swr_ctx = nullptr;
         };
 
+        static constexpr int FrameAlign = 64;
+
+        struct WriteItem
+        {
+            FrameRef Frame{};
+            int64_t Pts = 0;
+        };
+
+        struct Writer
+        {
+            CuThread::Channel<WriteItem, CuThread::Dynamics> Frames{};
+            std::thread Worker{};
+            // set by the worker before it closes Frames
+            std::exception_ptr Error{};
+
+            ~Writer()
+            {
+                Frames.Close();
+                if (Worker.joinable())
+                    Worker.join();
+            }
+        };
+
         struct Context
         {
             VideoStream video_st{};
@@ -1014,6 +1976,12 @@ namespace CuVid
             bool have_audio = 0;
             int encode_video = 0;
             int encode_audio = 0;
+
+            AVBufferPool *framePool = nullptr;
+            int framePoolSize = 0;
+
+            // last, so the worker is joined before the streams it writes are destroyed
+            std::unique_ptr<Writer> writer{};
         } Ctx{};
 
     public:
@@ -1057,6 +2025,15 @@ namespace CuVid
 
             int OutputStream = StreamTypeVideo;
 
+            // frame or slice threads of the video encoder, whichever the codec supports
+            bool UseMultiThread = true;
+
+            // Write copies the image into a queue of QueueSize frames and returns, conversion, encoding and muxing
+            // run on a worker thread. An error of the worker is rethrown by the next Write and by Finish, which still
+            // closes the output
+            bool Async = false;
+            int QueueSize = 8;
+
             [[nodiscard]] const char *GetOutputPath() const
             {
                 return reinterpret_cast<const char *>(OutputPath.c_str());
@@ -1071,6 +2048,22 @@ namespace CuVid
 
         Encoder() = default;
 
+        Encoder(const Encoder &) = delete;
+        // the writer of enc encodes the frames it has queued and stops, this encoder starts its own
+        Encoder(Encoder &&enc)
+        {
+            MoveFrom(enc);
+        }
+
+        Encoder &operator=(const Encoder &) = delete;
+        Encoder &operator=(Encoder &&enc)
+        {
+            // the worker writes through Ctx, it has to stop before Ctx is replaced
+            Ctx.writer.reset();
+            MoveFrom(enc);
+            return *this;
+        }
+
         AVFormatContext *GetAVFormatContext() { return Ctx.Oc; }
 
         void Init()
@@ -1084,6 +2077,8 @@ namespace CuVid
                 Config.Video.Validate();
             if (hasAudio)
                 Config.Audio.Validate();
+            if (Config.QueueSize <= 0)
+                ThrowEx("QueueSize must be positive");
 
             AV::AvformatAllocOutputContext2(&Ctx.Oc, nullptr, Config.GetFormatName(), Config.GetOutputPath());
 
@@ -1115,17 +2110,73 @@ namespace CuVid
             }
 
             AV::AvformatWriteHeader(Ctx.Oc, Config.Opt.Clone().AddressOf());
+
+            if (Config.Async && hasVideo)
+                StartWriter();
         }
 
         void Write(const CuImg::Image<T, CuImg::Backend::ConstRef> &frame, const int64_t pts)
         {
-            WriteVideoFrame(Ctx.Oc, &Ctx.video_st, frame, pts);
+            const auto *c = Ctx.video_st.enc;
+            auto src = Detail::AcquirePooledFrame(Ctx.framePool, Ctx.framePoolSize, Detail::CuImgTypeToFFmpegType<T>{}(),
+                                                  c->width, c->height, FrameAlign);
+            FillImage(src.Get(), frame);
+            Submit(std::move(src), pts);
+        }
+
+        // a frame in the codec's pixel format and size is referenced, not copied, so its buffers must not be written
+        // afterwards. Any other frame is converted and scaled to it
+        void Write(const AVFrame *frame, const int64_t pts)
+        {
+            FrameRef ref(Detail::AV::AvFrameClone(frame));
+            // a decoded frame keeps its picture type, which the encoder would take as a forced frame type
+            ref->pict_type = AV_PICTURE_TYPE_NONE;
+            Submit(std::move(ref), pts);
+        }
+
+        void Write(const FrameRef &frame, const int64_t pts)
+        {
+            Write(frame.Get(), pts);
+        }
+
+        // the view is encoded as the caller sees it, a gray view over a YUV frame encodes only its luma
+        void Write(const NativeFrame &frame, const int64_t pts)
+        {
+            FrameRef ref(Detail::AV::AvFrameClone(frame.Get()));
+            ref->format = frame.Format();
+            for (auto i = frame.Planes().size(); i < AV_NUM_DATA_POINTERS; ++i)
+            {
+                ref->data[i] = nullptr;
+                ref->linesize[i] = 0;
+            }
+            ref->pict_type = AV_PICTURE_TYPE_NONE;
+            Submit(std::move(ref), pts);
         }
 
         void Finish()
         {
             using namespace Detail;
-            AV::AvWriteTrailer(Ctx.Oc);
+
+            std::exception_ptr error{};
+            if (Ctx.writer)
+            {
+                auto writer = std::move(Ctx.writer);
+                writer->Frames.Close();
+                if (writer->Worker.joinable())
+                    writer->Worker.join();
+                error = writer->Error;
+            }
+            av_buffer_pool_uninit(&Ctx.framePool);
+
+            // the output is incomplete after a failed write, it is closed without a trailer
+            if (!error)
+            {
+                // delayed packets, frame threading holds back at least one frame per thread
+                if (Config.OutputStream & StreamTypeVideo)
+                    WriteFrame(Ctx.Oc, Ctx.video_st.enc, Ctx.video_st.st, nullptr, Ctx.video_st.tmp_pkt);
+
+                AV::AvWriteTrailer(Ctx.Oc);
+            }
 
             /* Close each codec. */
             if (Config.OutputStream & StreamTypeVideo)
@@ -1139,9 +2190,71 @@ namespace CuVid
 
             /* free the stream */
             avformat_free_context(Ctx.Oc);
+            Ctx.Oc = nullptr;
+
+            if (error)
+                std::rethrow_exception(error);
         }
 
     private:
+        void Submit(FrameRef frame, const int64_t pts)
+        {
+            if (!Ctx.writer)
+            {
+                WriteVideoFrame(std::move(frame), pts);
+                return;
+            }
+
+            if (!Ctx.writer->Frames.Write(WriteItem{std::move(frame), pts}))
+                std::rethrow_exception(Ctx.writer->Error);
+        }
+
+        void StartWriter()
+        {
+            auto writer = std::make_unique<Writer>();
+            writer->Frames.DynLimit = static_cast<size_t>(Config.QueueSize);
+
+            auto *w = writer.get();
+            writer->Worker = std::thread([this, w]()
+                                         {
+                                             try
+                                             {
+                                                 while (auto item = w->Frames.Receive())
+                                                     WriteVideoFrame(std::move(item->Frame), item->Pts);
+                                             }
+                                             catch (...)
+                                             {
+                                                 w->Error = std::current_exception();
+                                             }
+                                             w->Frames.Close(); });
+            Ctx.writer = std::move(writer);
+        }
+
+        void MoveFrom(Encoder &enc)
+        {
+            // the worker of enc writes through enc, so it is drained and joined before enc.Ctx moves
+            auto writer = std::move(enc.Ctx.writer);
+            if (writer)
+            {
+                writer->Frames.Close();
+                if (writer->Worker.joinable())
+                    writer->Worker.join();
+            }
+
+            Ctx = std::move(enc.Ctx);
+            Config = std::move(enc.Config);
+            enc.Ctx = {};
+            enc.Config = {};
+
+            if (!writer)
+                return;
+            // a failed writer is kept closed, Write and Finish still rethrow its error
+            if (writer->Error)
+                Ctx.writer = std::move(writer);
+            else
+                StartWriter();
+        }
+
         const AVCodec *GetCodec() const
         {
             using namespace Detail;
@@ -1205,7 +2318,18 @@ namespace CuVid
                 ost->st->time_base = Config.Video.TimeBase;
                 c->time_base = ost->st->time_base;
                 c->pix_fmt = Config.Video.PixelFormat.value_or(*(*codec)->pix_fmts);
-                ;
+                if (Config.UseMultiThread)
+                {
+                    c->thread_count = 0;
+                    if ((*codec)->capabilities & AV_CODEC_CAP_FRAME_THREADS)
+                    {
+                        c->thread_type = FF_THREAD_FRAME;
+                    }
+                    else if ((*codec)->capabilities & AV_CODEC_CAP_SLICE_THREADS)
+                    {
+                        c->thread_type = FF_THREAD_SLICE;
+                    }
+                }
                 break;
 
             default:
@@ -1217,21 +2341,6 @@ namespace CuVid
                 c->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
         }
 
-        static AVFrame *AllocFrame(enum AVPixelFormat pix_fmt, int width, int height)
-        {
-            using namespace Detail;
-
-            auto *frame = AV::AvFrameAlloc();
-
-            frame->format = pix_fmt;
-            frame->width = width;
-            frame->height = height;
-
-            AV::AvFrameGetBuffer(frame, 0);
-
-            return frame;
-        }
-
         static void OpenVideo(AVFormatContext *oc, const AVCodec *codec, Stream *ost, AVDictionary *optArg)
         {
             using namespace Detail;
@@ -1243,12 +2352,6 @@ namespace CuVid
 
             AV::AvcodecOpen2(c, codec, opt.AddressOf());
 
-            ost->frame = AllocFrame(c->pix_fmt, c->width, c->height);
-            if (constexpr auto t = CuImgTypeToFFmpegType<T>{}(); t != c->pix_fmt)
-            {
-                ost->tmp_frame = AllocFrame(t, c->width, c->height);
-            }
-
             AV::AvcodecParametersFromContext(ost->st->codecpar, c);
         }
 
@@ -1321,9 +2424,12 @@ namespace CuVid
          * encode one video frame and send it to the muxer
          * return 1 when encoding is finished, 0 otherwise
          */
-        int WriteVideoFrame(AVFormatContext *oc, VideoStream *ost, const VideoFrameType &frame, const int64_t pts)
+        int WriteVideoFrame(FrameRef frame, const int64_t pts)
         {
-            return WriteFrame(oc, ost->enc, ost->st, GetVideoFrame(ost, frame, pts), ost->tmp_pkt);
+            auto *ost = &Ctx.video_st;
+            auto out = ToCodecFrame(ost, std::move(frame));
+            out->pts = pts;
+            return WriteFrame(Ctx.Oc, ost->enc, ost->st, out.Get(), ost->tmp_pkt);
         }
 
         static int WriteFrame(AVFormatContext *fmt_ctx, AVCodecContext *c,
@@ -1368,35 +2474,24 @@ namespace CuVid
             CuImg::Convert(img, ref);
         }
 
-        AVFrame *GetVideoFrame(VideoStream *ost, const VideoFrameType &img, const int64_t pts)
+        // src already in the codec's format and size goes to the encoder as is, anything else is scaled into a
+        // pooled frame. The encoder may keep a reference to either, so neither is written again while it does
+        static FrameRef ToCodecFrame(VideoStream *ost, FrameRef src)
         {
             using namespace Detail;
 
             const auto *c = ost->enc;
+            if (src->format == c->pix_fmt && src->width == c->width && src->height == c->height)
+                return src;
 
-            /* when we pass a frame to the encoder, it may keep a reference to it
-             * internally; make sure we do not overwrite it here */
-
-            AV::AvFrameMakeWritable(ost->frame);
-
-            if (constexpr auto t = CuImgTypeToFFmpegType<T>{}(); c->pix_fmt != t)
-            {
-                ost->sws_ctx = AV::SwsGetCachedContext(ost->sws_ctx, c->width, c->height, t,
-                                                       c->width, c->height, c->pix_fmt, SWS_BICUBIC, nullptr, nullptr, nullptr);
-
-                FillImage(ost->tmp_frame, img);
-                sws_scale(ost->sws_ctx, (const uint8_t *const *)ost->tmp_frame->data,
-                          ost->tmp_frame->linesize, 0, c->height, ost->frame->data,
-                          ost->frame->linesize);
-            }
-            else
-            {
-                FillImage(ost->frame, img);
-            }
-
-            ost->frame->pts = pts;
+            auto dst = AcquirePooledFrame(ost->pool, ost->poolSize, c->pix_fmt, c->width, c->height, FrameAlign);
+            ost->sws_ctx = AV::SwsGetCachedContext(ost->sws_ctx, src->width, src->height, static_cast<AVPixelFormat>(src->format),
+                                                   c->width, c->height, c->pix_fmt, SWS_BICUBIC, nullptr, nullptr, nullptr);
+            sws_scale(ost->sws_ctx, (const uint8_t *const *)src->data,
+                      src->linesize, 0, src->height, dst->data,
+                      dst->linesize);
 
-            return ost->frame;
+            return dst;
         }
 
         template <typename T = Stream>
@@ -1410,6 +2505,7 @@ namespace CuVid
             if constexpr (std::is_same_v<T, VideoStream>)
             {
                 sws_freeContext(ost->sws_ctx);
+                av_buffer_pool_uninit(&ost->pool);
             }
             else if constexpr (std::is_same_v<T, AudioStream>)
             {